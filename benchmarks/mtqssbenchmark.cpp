@@ -0,0 +1,178 @@
+#include "mtqss.h"
+#include "mtqssparser.h"
+
+#include <QFile>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <memory>
+
+/**
+ * @class MTQssBenchmark
+ * @brief Compares MTQssParser with the regular expression MTQss::importQss() used before it, and the two
+ *        MTQss apply modes.
+ *
+ * Both parsers run over generated style sheets of about 30 KB and 300 KB with object and class rules,
+ * comments and gradient values. The apply benchmarks style a shown widget hierarchy in both apply modes
+ * and need a platform plugin, e.g. QT_QPA_PLATFORM=offscreen.
+ */
+class MTQssBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void regexParse_data();
+    void regexParse();
+    void tokenizerParse_data();
+    void tokenizerParse();
+    void applyStyles_data();
+    void applyStyles();
+    void polishCount();
+
+private:
+    static void addRows();
+    static QString generateStyleSheet(qsizetype minimumSize);
+    static std::unique_ptr<QWidget> createHierarchy();
+    static bool writeStyleSheet(const QString& fileName, const QString& color);
+};
+
+void MTQssBenchmark::addRows() {
+    QTest::addColumn<QString>("styleSheet");
+    QTest::newRow("30KB") << generateStyleSheet(30 * 1024);
+    QTest::newRow("300KB") << generateStyleSheet(300 * 1024);
+}
+
+QString MTQssBenchmark::generateStyleSheet(qsizetype minimumSize) {
+    QString text;
+    for (int i = 0; text.size() < minimumSize; ++i) {
+        text += QStringLiteral("/* widget %1 */\n#widget%1 {\n    color: #%2;\n    border: 1px solid gray;\n}\n\n")
+                    .arg(i)
+                    .arg(i % 0x1000, 3, 16, QLatin1Char('0'));
+        text += QStringLiteral("QLabel {\n    background: qlineargradient(x1: 0, y1: 0, x2: 1, y2: 1, stop: 0 white, stop: 1 #%1);\n"
+                               "    padding: 2px;\n}\n\n")
+                    .arg(i % 0x1000, 3, 16, QLatin1Char('0'));
+    }
+    return text;
+}
+
+void MTQssBenchmark::regexParse_data() {
+    addRows();
+}
+
+void MTQssBenchmark::regexParse() {
+    QFETCH(QString, styleSheet);
+
+    qsizetype rules = 0;
+    QBENCHMARK {
+        rules = 0;
+        QRegularExpression regex(R"(#(\w+)\s*{([\s\S]*?)}|(\w+)\s*{([\s\S]*?)})");
+        QRegularExpressionMatchIterator it = regex.globalMatch(styleSheet);
+        while (it.hasNext()) {
+            it.next();
+            ++rules;
+        }
+    }
+    QVERIFY(rules > 0);
+}
+
+void MTQssBenchmark::tokenizerParse_data() {
+    addRows();
+}
+
+void MTQssBenchmark::tokenizerParse() {
+    QFETCH(QString, styleSheet);
+
+    MTQssParser parser;
+    bool parsed = false;
+    QBENCHMARK {
+        parsed = parser.parse(styleSheet);
+    }
+    QVERIFY(parsed);
+    QVERIFY(!parser.rules().isEmpty());
+}
+
+void MTQssBenchmark::applyStyles_data() {
+    QTest::addColumn<int>("mode");
+    QTest::newRow("PerWidgetStyleSheets") << int(MTQss::PerWidgetStyleSheets);
+    QTest::newRow("MergedStyleSheet") << int(MTQss::MergedStyleSheet);
+}
+
+void MTQssBenchmark::applyStyles() {
+    QFETCH(int, mode);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString light = dir.filePath(QStringLiteral("light.qss"));
+    const QString dark = dir.filePath(QStringLiteral("dark.qss"));
+    QVERIFY(writeStyleSheet(light, QStringLiteral("black")));
+    QVERIFY(writeStyleSheet(dark, QStringLiteral("white")));
+
+    const std::unique_ptr<QWidget> window = createHierarchy();
+    QVERIFY(QTest::qWaitForWindowExposed(window.get()));
+    MTQss qss(window.get());
+    qss.setApplyMode(MTQss::ApplyMode(mode));
+
+    // Alternating themes, so every iteration changes the style sheets
+    bool toDark = true;
+    QBENCHMARK {
+        QVERIFY(qss.importQss(toDark ? dark : light));
+        toDark = !toDark;
+    }
+}
+
+void MTQssBenchmark::polishCount() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("theme.qss"));
+    QVERIFY(writeStyleSheet(fileName, QStringLiteral("black")));
+
+    int counts[2] = { 0, 0 };
+    for (MTQss::ApplyMode mode : { MTQss::PerWidgetStyleSheets, MTQss::MergedStyleSheet }) {
+        const std::unique_ptr<QWidget> window = createHierarchy();
+        QVERIFY(QTest::qWaitForWindowExposed(window.get()));
+        MTQss qss(window.get());
+        qss.setApplyMode(mode);
+        QVERIFY(qss.importQss(fileName));
+        counts[mode] = qss.lastPolishCount();
+    }
+    qDebug() << "Polish events per import:" << counts[MTQss::PerWidgetStyleSheets] << "per widget,"
+             << counts[MTQss::MergedStyleSheet] << "merged";
+
+    // Per-widget style sheets repolish the labels once for every styled group around them
+    QVERIFY(counts[MTQss::MergedStyleSheet] > 0);
+    QVERIFY(counts[MTQss::MergedStyleSheet] < counts[MTQss::PerWidgetStyleSheets]);
+}
+
+std::unique_ptr<QWidget> MTQssBenchmark::createHierarchy() {
+    auto window = std::make_unique<QWidget>();
+    window->setObjectName(QStringLiteral("window"));
+    for (int i = 0; i < 20; ++i) {
+        auto* group = new QWidget(window.get());
+        group->setObjectName(QStringLiteral("group%1").arg(i));
+        for (int j = 0; j < 10; ++j) {
+            auto* label = new QLabel(QStringLiteral("Label"), group);
+            label->setObjectName(QStringLiteral("label%1_%2").arg(i).arg(j));
+        }
+    }
+    window->show();
+    return window;
+}
+
+bool MTQssBenchmark::writeStyleSheet(const QString& fileName, const QString& color) {
+    QString text;
+    for (int i = 0; i < 20; ++i) {
+        text += QStringLiteral("#group%1 {\n    background: gray;\n}\n\n").arg(i);
+        for (int j = 0; j < 10; ++j) {
+            text += QStringLiteral("#label%1_%2 {\n    color: %3;\n}\n\n").arg(i).arg(j).arg(color);
+        }
+    }
+
+    const QByteArray data = text.toUtf8();
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Text) && file.write(data) == data.size();
+}
+
+QTEST_MAIN(MTQssBenchmark)
+
+#include "mtqssbenchmark.moc"
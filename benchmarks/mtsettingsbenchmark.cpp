@@ -0,0 +1,259 @@
+#include "mtsettings.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<quint64> allocationCount { 0 };
+
+/**
+ * @brief Returns the peak resident set size of the process in bytes.
+ */
+qint64 peakResidentSize() {
+#if defined(Q_OS_LINUX)
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+            }
+        }
+    }
+    return 0;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? qint64(counters.PeakWorkingSetSize) : 0;
+#elif defined(Q_OS_MACOS)
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? qint64(usage.ru_maxrss) : 0;
+#elif defined(Q_OS_UNIX)
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? qint64(usage.ru_maxrss) * 1024 : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Resets the peak resident set size where the platform allows it (Linux only), so every row reports its own peak.
+ */
+void resetPeakResidentSize() {
+#if defined(Q_OS_LINUX)
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+} // namespace
+
+// Every heap allocation in the process is counted, including those made by Qt
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+/**
+ * @class MTSettingsBenchmark
+ * @brief Measures MTSettings::exportSettings() and importSettings() for every format and several store sizes.
+ *
+ * Besides the QBENCHMARK timing, every row prints its throughput, heap allocations per run and peak RSS.
+ * The largest store size can be limited with the MTSETTINGS_BENCH_MAX_KEYS environment variable.
+ */
+class MTSettingsBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void exportSettings_data();
+    void exportSettings();
+    void importSettings_data();
+    void importSettings();
+
+private:
+    QTemporaryDir m_dir;
+    QMap<int, std::shared_ptr<MTSettings>> m_stores;  ///< Populated stores by key count
+
+    void addRows();
+    MTSettings& store(int keyCount);
+    QString fileName(MTSettings::ExportFormat format, int keyCount) const;
+    void report(const char* operation, qint64 elapsedNs, int iterations, int keyCount, qint64 bytes, quint64 allocations);
+};
+
+void MTSettingsBenchmark::initTestCase() {
+    QVERIFY(m_dir.isValid());
+}
+
+void MTSettingsBenchmark::cleanupTestCase() {
+    for (const auto& settings : std::as_const(m_stores)) {
+        settings->clear();
+        settings->sync();
+    }
+    m_stores.clear();
+}
+
+void MTSettingsBenchmark::addRows() {
+    QTest::addColumn<int>("formatId");
+    QTest::addColumn<int>("keyCount");
+
+    const struct {
+        MTSettings::ExportFormat format;
+        const char* name;
+    } formats[] = {
+        { MTSettings::JsonFormat, "json" },
+        { MTSettings::IniFormat, "ini" },
+        { MTSettings::XmlFormat, "xml" },
+        { MTSettings::CsvFormat, "csv" },
+        { MTSettings::PlainTextFormat, "text" },
+        { MTSettings::BinarySnapshotFormat, "snapshot" },
+    };
+
+    bool limited = false;
+    const int maxKeys = qEnvironmentVariableIntValue("MTSETTINGS_BENCH_MAX_KEYS", &limited);
+    for (const int keyCount : { 1000, 100000, 1000000 }) {
+        if (limited && keyCount > maxKeys) {
+            continue;
+        }
+        for (const auto& format : formats) {
+            QTest::addRow("%s/%d", format.name, keyCount) << int(format.format) << keyCount;
+        }
+    }
+}
+
+MTSettings& MTSettingsBenchmark::store(int keyCount) {
+    std::shared_ptr<MTSettings>& settings = m_stores[keyCount];
+    if (!settings) {
+        // The stores are INI files in the temporary directory: the native format would write to the Windows
+        // registry or a macOS plist, outside the reach of QStandardPaths test mode
+        settings = std::make_shared<MTSettings>(m_dir.filePath(QStringLiteral("store%1.ini").arg(keyCount)), QSettings::IniFormat);
+        settings->clear();
+        settings->beginTransaction();
+        for (int i = 0; i < keyCount; ++i) {
+            settings->stageValue(QStringLiteral("group%1/key%2").arg(i / 100).arg(i % 100),
+                                 QStringLiteral("value %1, \"quoted\"").arg(i));
+        }
+        settings->commitTransaction();
+    }
+    return *settings;
+}
+
+QString MTSettingsBenchmark::fileName(MTSettings::ExportFormat format, int keyCount) const {
+    return m_dir.filePath(QStringLiteral("settings-%1-%2").arg(int(format)).arg(keyCount));
+}
+
+void MTSettingsBenchmark::report(const char* operation, qint64 elapsedNs, int iterations, int keyCount, qint64 bytes,
+                                 quint64 allocations) {
+    const double seconds = double(elapsedNs) / 1e9 / iterations;
+    qInfo("%s %s: %.0f keys/s, %.1f MB/s, %llu allocations per run, peak RSS %.1f MB",
+          operation, QTest::currentDataTag(), keyCount / seconds, bytes / seconds / (1024.0 * 1024.0),
+          static_cast<unsigned long long>(allocations / quint64(iterations)), peakResidentSize() / (1024.0 * 1024.0));
+}
+
+void MTSettingsBenchmark::exportSettings_data() {
+    addRows();
+}
+
+void MTSettingsBenchmark::exportSettings() {
+    QFETCH(int, formatId);
+    QFETCH(int, keyCount);
+    const auto format = static_cast<MTSettings::ExportFormat>(formatId);
+
+    MTSettings& settings = store(keyCount);
+    const QString file = fileName(format, keyCount);
+
+    resetPeakResidentSize();
+    int iterations = 0;
+    bool exported = true;
+    const quint64 allocationsBefore = allocationCount.load();
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        exported = settings.exportSettings(format, file) && exported;
+        ++iterations;
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    const quint64 allocations = allocationCount.load() - allocationsBefore;
+
+    QVERIFY(exported);
+    report("export", elapsed, iterations, keyCount, QFileInfo(file).size(), allocations);
+}
+
+void MTSettingsBenchmark::importSettings_data() {
+    addRows();
+}
+
+void MTSettingsBenchmark::importSettings() {
+    QFETCH(int, formatId);
+    QFETCH(int, keyCount);
+    const auto format = static_cast<MTSettings::ExportFormat>(formatId);
+
+    MTSettings& settings = store(keyCount);
+    const QString file = fileName(format, keyCount);
+    if (!QFile::exists(file)) {
+        QVERIFY(settings.exportSettings(format, file));
+    }
+
+    resetPeakResidentSize();
+    int iterations = 0;
+    bool imported = true;
+    const quint64 allocationsBefore = allocationCount.load();
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        imported = settings.importSettings(format, file) && imported;
+        ++iterations;
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    const quint64 allocations = allocationCount.load() - allocationsBefore;
+
+    QVERIFY(imported);
+    report("import", elapsed, iterations, keyCount, QFileInfo(file).size(), allocations);
+}
+
+QTEST_GUILESS_MAIN(MTSettingsBenchmark)
+
+#include "mtsettingsbenchmark.moc"
@@ -0,0 +1 @@
+#include "decimatedseries.h"
@@ -0,0 +1,174 @@
+#ifndef DECIMATEDSERIES_H
+#define DECIMATEDSERIES_H
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+#include <QPointF>
+#include <QtCharts/QChart>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QDateTimeAxis>
+#include <QtCharts/QValueAxis>
+
+#include <algorithm>
+
+// Warstwa decymacji dla dużych serii (miliony punktów).
+// Pełne dane są trzymane poza sceną w dwóch tablicach (x rosnąco, y), a do QLineSeries trafia tylko
+// reprezentacja w rozdzielczości ekranu: dla każdego piksela widocznego zakresu pierwszy, najmniejszy,
+// największy i ostatni punkt. Kształt linii (także pojedyncze piki) zostaje zachowany, a seria nigdy nie ma
+// więcej niż ok. 4 punkty na piksel. Widok jest przeliczany przy każdej zmianie zakresu osi X i szerokości
+// obszaru wykresu i wstawiany jednym wywołaniem replace().
+class DecimatedSeries : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DecimatedSeries(QLineSeries *series, QAbstractAxis *axisX, QChart *chart)
+        : QObject(chart)
+        , m_series(series)
+        , m_axisX(axisX)
+        , m_chart(chart)
+    {
+        if (QDateTimeAxis *dateTimeAxis = qobject_cast<QDateTimeAxis *>(axisX)) {
+            connect(dateTimeAxis, &QDateTimeAxis::rangeChanged, this, &DecimatedSeries::updateView);
+        } else if (QValueAxis *valueAxis = qobject_cast<QValueAxis *>(axisX)) {
+            connect(valueAxis, &QValueAxis::rangeChanged, this, &DecimatedSeries::updateView);
+        }
+        connect(chart, &QChart::plotAreaChanged, this, &DecimatedSeries::updateView);
+    }
+
+    // Zastępuje wszystkie dane; xs musi być posortowane rosnąco (dla osi czasu: ms od epoki)
+    void setData(QList<qreal> xs, QList<qreal> ys) {
+        const qsizetype count = qMin(xs.size(), ys.size());
+        xs.resize(count);
+        ys.resize(count);
+        m_xs = std::move(xs);
+        m_ys = std::move(ys);
+        updateView();
+    }
+
+    // Dopisuje punkty na końcu; x nie może być mniejszy niż ostatni zapisany
+    void append(const QList<QPointF> &points) {
+        m_xs.reserve(m_xs.size() + points.size());
+        m_ys.reserve(m_ys.size() + points.size());
+        for (const QPointF &point : points) {
+            m_xs.append(point.x());
+            m_ys.append(point.y());
+        }
+        updateView();
+    }
+
+    void clear() {
+        m_xs.clear();
+        m_ys.clear();
+        updateView();
+    }
+
+    qsizetype size() const {
+        return m_xs.size();
+    }
+
+    QLineSeries *series() const {
+        return m_series;
+    }
+
+    // Maksymalna liczba punktów na piksel, przy której dane są przekazywane bez decymacji
+    void setRawPointsPerPixel(int count) {
+        m_rawPointsPerPixel = qMax(1, count);
+        updateView();
+    }
+
+public slots:
+    void updateView() {
+        if (!m_series || !m_axisX || !m_chart) {
+            return;
+        }
+
+        qreal minX = 0;
+        qreal maxX = 0;
+        if (!visibleRange(minX, maxX)) {
+            return;
+        }
+        const int pixels = qMax(1, qRound(m_chart->plotArea().width()));
+
+        // Widoczny fragment plus po jednym punkcie z każdej strony, żeby linia dochodziła do krawędzi
+        qsizetype first = std::lower_bound(m_xs.cbegin(), m_xs.cend(), minX) - m_xs.cbegin();
+        qsizetype last = std::upper_bound(m_xs.cbegin(), m_xs.cend(), maxX) - m_xs.cbegin();
+        first = qMax<qsizetype>(0, first - 1);
+        last = qMin(m_xs.size(), last + 1);
+
+        QList<QPointF> points;
+        if (last - first <= qsizetype(m_rawPointsPerPixel) * pixels) {
+            points.reserve(last - first);
+            for (qsizetype i = first; i < last; ++i) {
+                points.append(QPointF(m_xs[i], m_ys[i]));
+            }
+        } else {
+            points.reserve(4 * pixels + 4);
+            const qreal bucketWidth = (maxX - minX) / pixels;
+            qsizetype begin = first;
+            for (int pixel = 0; pixel < pixels && begin < last; ++pixel) {
+                qsizetype end = last;
+                if (pixel < pixels - 1) {
+                    const qreal bucketEnd = minX + (pixel + 1) * bucketWidth;
+                    end = std::upper_bound(m_xs.cbegin() + begin, m_xs.cbegin() + last, bucketEnd) - m_xs.cbegin();
+                }
+                if (end > begin) {
+                    appendBucket(points, begin, end);
+                    begin = end;
+                }
+            }
+        }
+
+        m_series->replace(points);  // Jedno przerysowanie zamiast jednego na punkt
+    }
+
+private:
+    QPointer<QLineSeries> m_series;
+    QPointer<QAbstractAxis> m_axisX;
+    QChart *m_chart;
+    QList<qreal> m_xs;  // Pełne dane, x rosnąco
+    QList<qreal> m_ys;
+    int m_rawPointsPerPixel = 4;
+
+    bool visibleRange(qreal &minX, qreal &maxX) const {
+        if (QDateTimeAxis *dateTimeAxis = qobject_cast<QDateTimeAxis *>(m_axisX)) {
+            minX = dateTimeAxis->min().toMSecsSinceEpoch();
+            maxX = dateTimeAxis->max().toMSecsSinceEpoch();
+        } else if (QValueAxis *valueAxis = qobject_cast<QValueAxis *>(m_axisX)) {
+            minX = valueAxis->min();
+            maxX = valueAxis->max();
+        } else {
+            return false;
+        }
+        return maxX > minX;
+    }
+
+    // Dodaje pierwszy, najmniejszy, największy i ostatni punkt przedziału [begin, end) w kolejności indeksów
+    void appendBucket(QList<QPointF> &points, qsizetype begin, qsizetype end) const {
+        const qreal *ys = m_ys.constData();
+
+        // Pętla bez rozgałęzień i zależności między iteracjami poza redukcją - kompilator może ją zwektoryzować
+        qreal low = ys[begin];
+        qreal high = ys[begin];
+        for (qsizetype i = begin + 1; i < end; ++i) {
+            low = ys[i] < low ? ys[i] : low;
+            high = ys[i] > high ? ys[i] : high;
+        }
+        qsizetype lowIndex = std::find(ys + begin, ys + end, low) - ys;
+        qsizetype highIndex = std::find(ys + begin, ys + end, high) - ys;
+        if (lowIndex == end || highIndex == end) {  // NaN w danych
+            lowIndex = highIndex = begin;
+        }
+
+        qsizetype indices[] = { begin, qMin(lowIndex, highIndex), qMax(lowIndex, highIndex), end - 1 };
+        qsizetype previous = -1;
+        for (qsizetype index : indices) {
+            if (index != previous) {
+                points.append(QPointF(m_xs[index], ys[index]));
+                previous = index;
+            }
+        }
+    }
+};
+
+#endif // DECIMATEDSERIES_H
@@ -0,0 +1,224 @@
+#include "mtgzipdevice.h"
+#include <QCoreApplication>
+
+#include <zlib.h>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int ChunkSize = 64 * 1024;
+constexpr int GzipWindowBits = 15 + 16;        ///< Maximum window, gzip header and trailer
+constexpr int AutoDetectWindowBits = 15 + 32;  ///< Maximum window, accept gzip or zlib headers
+constexpr qint64 MaxInputChunk = 1 << 30;      ///< zlib counts input in uInt
+
+} // namespace
+
+/**
+ * @brief Constructs a device compressing into or inflating from target.
+ * @param target The device receiving the compressed data, open for writing, or providing it, open for reading.
+ * @param level The zlib compression level (0-9), or -1 for the default level. Ignored when reading.
+ */
+MTGzipDevice::MTGzipDevice(QIODevice* target, int level)
+    : m_target(target)
+    , m_level(level)
+    , m_buffer(ChunkSize, Qt::Uninitialized) {}
+
+/**
+ * @brief Finishes the stream if the device is still open.
+ */
+MTGzipDevice::~MTGzipDevice() {
+    if (isOpen()) {
+        close();
+    }
+}
+
+/**
+ * @brief Opens the device for compressing (QIODevice::WriteOnly) or inflating (QIODevice::ReadOnly).
+ */
+bool MTGzipDevice::open(OpenMode mode) {
+    const bool reading = mode & QIODevice::ReadOnly;
+    const bool writing = mode & QIODevice::WriteOnly;
+    if (reading == writing || !m_target || (reading ? !m_target->isReadable() : !m_target->isWritable())) {
+        setErrorString(QCoreApplication::translate("MTGzipDevice", "Only reading from or writing to an open device is supported."));
+        return false;
+    }
+
+    m_inflating = reading;
+    m_streamEnded = false;
+    m_failed = false;
+    m_stream = std::make_unique<z_stream_s>();
+    const int result = reading ? inflateInit2(m_stream.get(), AutoDetectWindowBits)
+                               : deflateInit2(m_stream.get(), m_level, Z_DEFLATED, GzipWindowBits, 8, Z_DEFAULT_STRATEGY);
+    if (result != Z_OK) {
+        setErrorString(QCoreApplication::translate("MTGzipDevice", "Failed to initialize compression."));
+        m_stream.reset();
+        return false;
+    }
+    return QIODevice::open(mode);
+}
+
+/**
+ * @brief Flushes the remaining compressed data and writes the gzip trailer. In read mode, ends inflating.
+ * @return True if the whole stream reached the target device or was read without errors, false otherwise.
+ */
+bool MTGzipDevice::finish() {
+    if (m_stream && m_inflating) {
+        inflateEnd(m_stream.get());
+        m_stream.reset();
+    } else if (m_stream) {
+        m_stream->next_in = nullptr;
+        m_stream->avail_in = 0;
+        if (!deflateChunks(Z_FINISH)) {
+            m_failed = true;
+        }
+        deflateEnd(m_stream.get());
+        m_stream.reset();
+    }
+    return !m_failed;
+}
+
+/**
+ * @brief Finishes the stream and closes the device.
+ */
+void MTGzipDevice::close() {
+    finish();
+    QIODevice::close();
+}
+
+/**
+ * @brief Returns true if the device starts with the gzip magic bytes. The read position is not changed.
+ */
+bool MTGzipDevice::isCompressed(QIODevice* device) {
+    const QByteArray magic = device->peek(2);
+    return magic.size() == 2 && static_cast<uchar>(magic[0]) == 0x1f && static_cast<uchar>(magic[1]) == 0x8b;
+}
+
+/**
+ * @brief Decompresses a gzip or zlib stream chunk by chunk into a device.
+ * @param compressed The compressed data, e.g. a memory-mapped file.
+ * @param out The device receiving the decompressed data.
+ * @return True if the whole stream was decompressed, false on corrupt or truncated input.
+ */
+bool MTGzipDevice::decompress(QByteArrayView compressed, QIODevice* out) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, AutoDetectWindowBits) != Z_OK) {
+        return false;
+    }
+
+    QByteArray buffer(ChunkSize, Qt::Uninitialized);
+    qint64 consumed = 0;
+    int result = Z_OK;
+    while (result != Z_STREAM_END) {
+        if (stream.avail_in == 0) {
+            const qint64 length = std::min(compressed.size() - consumed, MaxInputChunk);
+            if (length == 0) {
+                break;  // truncated input
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data() + consumed));
+            stream.avail_in = static_cast<uInt>(length);
+            consumed += length;
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = ChunkSize;
+        result = inflate(&stream, Z_NO_FLUSH);
+        if (result != Z_OK && result != Z_STREAM_END) {
+            break;
+        }
+
+        const qint64 produced = ChunkSize - stream.avail_out;
+        if (produced > 0 && out->write(buffer.constData(), produced) != produced) {
+            result = Z_ERRNO;
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+/**
+ * @brief Inflates compressed data read from the target device chunk by chunk.
+ *
+ * Blocks until at least one byte is produced, so a return value of 0 always means the end of the stream.
+ */
+qint64 MTGzipDevice::readData(char* data, qint64 maxSize) {
+    if (!m_stream || !m_inflating || m_failed) {
+        return -1;
+    }
+    if (m_streamEnded || maxSize <= 0) {
+        return 0;
+    }
+
+    const uInt requested = static_cast<uInt>(std::min(maxSize, MaxInputChunk));
+    m_stream->next_out = reinterpret_cast<Bytef*>(data);
+    m_stream->avail_out = requested;
+    while (m_stream->avail_out == requested) {
+        if (m_stream->avail_in == 0) {
+            const qint64 length = m_target->read(m_buffer.data(), ChunkSize);
+            if (length <= 0) {
+                setErrorString(QCoreApplication::translate("MTGzipDevice", "Unexpected end of compressed data."));
+                m_failed = true;
+                return -1;
+            }
+            m_stream->next_in = reinterpret_cast<Bytef*>(m_buffer.data());
+            m_stream->avail_in = static_cast<uInt>(length);
+        }
+
+        const int result = inflate(m_stream.get(), Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            m_streamEnded = true;
+            break;
+        }
+        if (result != Z_OK) {
+            setErrorString(QCoreApplication::translate("MTGzipDevice", "Corrupt compressed data."));
+            m_failed = true;
+            return -1;
+        }
+    }
+    return requested - m_stream->avail_out;
+}
+
+qint64 MTGzipDevice::writeData(const char* data, qint64 size) {
+    if (!m_stream || m_inflating) {
+        return -1;
+    }
+
+    qint64 written = 0;
+    while (written < size) {
+        const qint64 length = std::min(size - written, MaxInputChunk);
+        m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + written));
+        m_stream->avail_in = static_cast<uInt>(length);
+        if (!deflateChunks(Z_NO_FLUSH)) {
+            m_failed = true;
+            return -1;
+        }
+        written += length;
+    }
+    return written;
+}
+
+/**
+ * @brief Runs deflate until the pending input is consumed (or the stream is finished for Z_FINISH)
+ *        and hands every produced chunk to the target device.
+ */
+bool MTGzipDevice::deflateChunks(int flush) {
+    int result = Z_OK;
+    do {
+        m_stream->next_out = reinterpret_cast<Bytef*>(m_buffer.data());
+        m_stream->avail_out = ChunkSize;
+        result = deflate(m_stream.get(), flush);
+        if (result == Z_STREAM_ERROR) {
+            setErrorString(QCoreApplication::translate("MTGzipDevice", "Compression failed."));
+            return false;
+        }
+
+        const qint64 produced = ChunkSize - m_stream->avail_out;
+        if (produced > 0 && m_target->write(m_buffer.constData(), produced) != produced) {
+            setErrorString(m_target->errorString());
+            return false;
+        }
+    } while (m_stream->avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+    return true;
+}
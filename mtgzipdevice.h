@@ -0,0 +1,86 @@
+#ifndef MTGZIPDEVICE_H
+#define MTGZIPDEVICE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QIODevice>
+
+#include <memory>
+
+struct z_stream_s;
+
+/**
+ * @class MTGzipDevice
+ * @brief Sequential QIODevice that gzip-compresses everything written to it into another device,
+ *        or inflates a gzip or zlib stream read from another device.
+ *
+ * Data is deflated or inflated in fixed-size chunks, so the uncompressed stream is never held in memory.
+ * The output is a standard .gz stream that can be read by gzip, zlib, decompress() or this device in read mode.
+ */
+class MTGzipDevice : public QIODevice {
+public:
+    /**
+     * @brief Constructs a device compressing into or inflating from target.
+     * @param target The device receiving the compressed data, open for writing, or providing it, open for reading.
+     * @param level The zlib compression level (0-9), or -1 for the default level. Ignored when reading.
+     */
+    explicit MTGzipDevice(QIODevice* target, int level = -1);
+
+    /**
+     * @brief Finishes the stream if the device is still open.
+     */
+    ~MTGzipDevice() override;
+
+    /**
+     * @brief Opens the device for compressing (QIODevice::WriteOnly) or inflating (QIODevice::ReadOnly).
+     */
+    bool open(OpenMode mode) override;
+
+    /**
+     * @brief Flushes the remaining compressed data and writes the gzip trailer. In read mode, ends inflating.
+     * @return True if the whole stream reached the target device or was read without errors, false otherwise.
+     */
+    bool finish();
+
+    /**
+     * @brief Returns true if compressing or inflating failed, e.g. on corrupt or truncated input.
+     */
+    bool hasError() const { return m_failed; }
+
+    /**
+     * @brief Finishes the stream and closes the device.
+     */
+    void close() override;
+
+    bool isSequential() const override { return true; }
+
+    /**
+     * @brief Returns true if the device starts with the gzip magic bytes. The read position is not changed.
+     */
+    static bool isCompressed(QIODevice* device);
+
+    /**
+     * @brief Decompresses a gzip or zlib stream chunk by chunk into a device.
+     * @param compressed The compressed data, e.g. a memory-mapped file.
+     * @param out The device receiving the decompressed data.
+     * @return True if the whole stream was decompressed, false on corrupt or truncated input.
+     */
+    static bool decompress(QByteArrayView compressed, QIODevice* out);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 size) override;
+
+private:
+    QIODevice* m_target;
+    int m_level;
+    std::unique_ptr<z_stream_s> m_stream;
+    QByteArray m_buffer;  ///< Output chunk handed to the target device, or input chunk read from it
+    bool m_inflating = false;
+    bool m_streamEnded = false;
+    bool m_failed = false;
+
+    bool deflateChunks(int flush);
+};
+
+#endif // MTGZIPDEVICE_H
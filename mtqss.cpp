@@ -1,5 +1,148 @@
 #include "mtqss.h"
-#include <QRegularExpression>
+#include "mtqssprofiler.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <optional>
+
+namespace {
+
+const QByteArray CompiledMagic = QByteArrayLiteral("MTQC");
+constexpr quint32 CompiledFormatVersion = 3;
+constexpr QDataStream::Version CompiledStreamVersion = QDataStream::Qt_6_5;
+
+/**
+ * @brief Returns the number of ancestors of a widget.
+ */
+int widgetDepth(const QWidget* widget) {
+    int depth = 0;
+    while ((widget = widget->parentWidget())) {
+        ++depth;
+    }
+    return depth;
+}
+
+/**
+ * @brief Returns a selector for a widget in its own style sheet that does not match its descendants.
+ *
+ * A named widget is selected by its name. ".Class" alone would also match descendants of the same class that
+ * inherit the style sheet, so an unnamed widget is selected by the classes of its parents, joined with child
+ * combinators, up to the nearest named ancestor or the window.
+ * @param unique Set to false if a descendant of the same class still matches, because its parents repeat the chain.
+ */
+QString selfSelector(const QWidget* widget, bool* unique) {
+    *unique = true;
+    if (!widget->objectName().isEmpty()) {
+        return QStringLiteral("#") + widget->objectName();
+    }
+
+    QList<const QWidget*> chain { widget };
+    QString selector = QStringLiteral(".") + QLatin1StringView(widget->metaObject()->className());
+    for (const QWidget* ancestor = widget->parentWidget(); ancestor; ancestor = ancestor->parentWidget()) {
+        chain.append(ancestor);
+        if (!ancestor->objectName().isEmpty()) {
+            selector.prepend(QStringLiteral("#") + ancestor->objectName() + QStringLiteral(" > "));
+            break;
+        }
+        selector.prepend(QStringLiteral(".") + QLatin1StringView(ancestor->metaObject()->className())
+                         + QStringLiteral(" > "));
+    }
+
+    const QList<QWidget*> descendants = widget->findChildren<QWidget*>();
+    for (const QWidget* descendant : descendants) {
+        const QWidget* current = descendant;
+        qsizetype level = 0;
+        for (; level < chain.size() && current; ++level, current = current->parentWidget()) {
+            const QWidget* expected = chain[level];
+            const bool anchor = level == chain.size() - 1 && !expected->objectName().isEmpty();
+            if (anchor ? current->objectName() != expected->objectName()
+                       : qstrcmp(current->metaObject()->className(), expected->metaObject()->className()) != 0) {
+                break;
+            }
+        }
+        if (level == chain.size()) {
+            *unique = false;
+            break;
+        }
+    }
+    return selector;
+}
+
+/**
+ * @brief Result of reading and parsing a QSS file on a worker thread.
+ */
+struct ParsedQss {
+    std::optional<QList<MTQssParser::Rule>> rules;  ///< Empty if the file could not be read
+    qint64 readStart = 0;                            ///< Profiler times, 0 if profiling is disabled
+    qint64 parseStart = 0;
+    qint64 parseEnd = 0;
+};
+
+void writeRules(QDataStream& out, const QList<MTQssParser::Rule>& rules) {
+    out << static_cast<quint32>(rules.size());
+    for (const MTQssParser::Rule& rule : rules) {
+        out << static_cast<qint64>(rule.position) << static_cast<quint32>(rule.selectors.size());
+        for (const MTQssParser::Selector& selector : rule.selectors) {
+            out << selector.text << static_cast<quint32>(selector.parts.size());
+            for (const MTQssParser::SelectorPart& part : selector.parts) {
+                out << part.className << part.exactClass << part.objectName << part.attributes << part.pseudoStates
+                    << part.subControl << static_cast<qint32>(part.combinator);
+            }
+        }
+        out << static_cast<quint32>(rule.declarations.size());
+        for (const MTQssParser::Declaration& declaration : rule.declarations) {
+            out << declaration.property << declaration.value;
+        }
+    }
+}
+
+void readRules(QDataStream& in, QList<MTQssParser::Rule>& rules) {
+    quint32 ruleCount = 0;
+    in >> ruleCount;
+    for (quint32 r = 0; r < ruleCount && in.status() == QDataStream::Ok; ++r) {
+        MTQssParser::Rule rule;
+        qint64 position = 0;
+        quint32 selectorCount = 0;
+        in >> position >> selectorCount;
+        rule.position = position;
+        for (quint32 s = 0; s < selectorCount && in.status() == QDataStream::Ok; ++s) {
+            MTQssParser::Selector selector;
+            quint32 partCount = 0;
+            in >> selector.text >> partCount;
+            for (quint32 p = 0; p < partCount && in.status() == QDataStream::Ok; ++p) {
+                MTQssParser::SelectorPart part;
+                qint32 combinator = 0;
+                in >> part.className >> part.exactClass >> part.objectName >> part.attributes >> part.pseudoStates
+                    >> part.subControl >> combinator;
+                part.combinator = static_cast<MTQssParser::Combinator>(combinator);
+                selector.parts.append(part);
+            }
+            rule.selectors.append(selector);
+        }
+        quint32 declarationCount = 0;
+        in >> declarationCount;
+        for (quint32 d = 0; d < declarationCount && in.status() == QDataStream::Ok; ++d) {
+            MTQssParser::Declaration declaration;
+            in >> declaration.property >> declaration.value;
+            rule.declarations.append(declaration);
+        }
+        rules.append(rule);
+    }
+}
+
+} // namespace
 
 /**
  * @brief Constructs an MTQss object with a parent widget.
@@ -10,10 +153,15 @@ MTQss::MTQss(QWidget* parent)
 
 /**
  * @brief Exports QSS styles for the given widget and its children.
+ *
+ * By default one object rule and one class rule is written per widget. With GroupRules, widgets are grouped
+ * by style text and each style is written once; a class selector appears once per distinct style.
+ * The output is streamed to the file as the widgets are visited.
  * @param fileName The name of the QSS file to export.
+ * @param options Grouping and minification options.
  * @return True if the export was successful, false otherwise.
  */
-bool MTQss::exportQss(const QString& fileName) {
+bool MTQss::exportQss(const QString& fileName, ExportOptions options) {
     if (!parent()) {
         qWarning() << tr("Parent widget is null.");
         return false;
@@ -26,41 +174,127 @@ bool MTQss::exportQss(const QString& fileName) {
     }
 
     QTextStream out(&file);
+    const bool minify = options.testFlag(Minify);
 
     // Recursive scan for child widgets
     QList<QWidget*> widgets = parent()->findChildren<QWidget*>();
     widgets.prepend(qobject_cast<QWidget *>(parent())); // Include the parent widget
 
-    for (QWidget* widget : widgets) {
-        QString className = widget->metaObject()->className();
-        QString objectName = widget->objectName();
-        QString styleSheet = widget->styleSheet();
+    if (options.testFlag(GroupRules)) {
+        // Only selectors are collected; the style text is shared with the widget and written once per group
+        struct Group {
+            QString styleSheet;
+            QStringList selectors;
+            QSet<QString> seen;
+        };
+        QList<Group> groups;
+        QHash<QString, qsizetype> groupIndex;
+        const auto addSelector = [&](const QString& selector, const QString& styleSheet) {
+            auto it = groupIndex.constFind(styleSheet);
+            if (it == groupIndex.constEnd()) {
+                it = groupIndex.insert(styleSheet, groups.size());
+                groups.append({ styleSheet, QStringList(), QSet<QString>() });
+            }
+            Group& group = groups[it.value()];
+            if (!group.seen.contains(selector)) {
+                group.seen.insert(selector);
+                group.selectors.append(selector);
+            }
+        };
+
+        for (QWidget* widget : std::as_const(widgets)) {
+            const QString styleSheet = widget->styleSheet();
+            if (!widget->objectName().isEmpty()) {
+                addSelector(u'#' + widget->objectName(), styleSheet);
+            }
+            addSelector(QString::fromLatin1(widget->metaObject()->className()), styleSheet);
+        }
 
-        // Write object-specific styles
-        if (!objectName.isEmpty()) {
-            out << "#" << objectName << " {\n";
-            if (!styleSheet.isEmpty()) {
-                out << "    " << styleSheet << "\n";
-            } else {
-                out << "    \n";
+        for (const Group& group : std::as_const(groups)) {
+            for (qsizetype i = 0; i < group.selectors.size(); ++i) {
+                if (i > 0) {
+                    out << (minify ? "," : ",\n");
+                }
+                out << group.selectors[i];
             }
-            out << "}\n\n";
+            writeBlock(out, group.styleSheet, minify);
         }
+    } else {
+        for (QWidget* widget : std::as_const(widgets)) {
+            const char* className = widget->metaObject()->className();
+            const QString objectName = widget->objectName();
+            const QString styleSheet = widget->styleSheet();
 
-        // Write class-specific styles
-        if (!className.isEmpty()) {
-            out << className << " {\n";
-            if (!styleSheet.isEmpty()) {
-                out << "    " << styleSheet << "\n";
-            } else {
-                out << "    \n";
+            // Write object-specific styles
+            if (!objectName.isEmpty()) {
+                out << "#" << objectName;
+                writeBlock(out, styleSheet, minify);
+            }
+
+            // Write class-specific styles
+            if (*className) {
+                out << className;
+                writeBlock(out, styleSheet, minify);
             }
-            out << "}\n\n";
         }
     }
 
+    out.flush();
     file.close();
-    return true;
+    return out.status() == QTextStream::Ok;
+}
+
+/**
+ * @brief Writes a declaration block after its selector.
+ * @param out The output stream.
+ * @param styleSheet The style text of the block.
+ * @param minify True to write the block without optional whitespace and comments.
+ */
+void MTQss::writeBlock(QTextStream& out, const QString& styleSheet, bool minify) {
+    if (!minify) {
+        out << " {\n    " << styleSheet << "\n}\n\n";
+        return;
+    }
+
+    out << '{';
+    // Whitespace runs collapse to one space, which is dropped next to punctuation; strings are copied as is
+    const qsizetype size = styleSheet.size();
+    bool pendingSpace = false;
+    QChar previous = u'{';
+    for (qsizetype i = 0; i < size; ++i) {
+        const QChar c = styleSheet[i];
+        if (c == u'/' && i + 1 < size && styleSheet[i + 1] == u'*') {
+            const qsizetype end = styleSheet.indexOf(QStringLiteral("*/"), i + 2);
+            i = end < 0 ? size : end + 1;
+            pendingSpace = true;
+            continue;
+        }
+        if (c.isSpace()) {
+            pendingSpace = true;
+            continue;
+        }
+
+        const bool tight = QStringView(u"{};,:").contains(previous) || QStringView(u"{};,").contains(c);
+        if (pendingSpace && !tight) {
+            out << ' ';
+        }
+        pendingSpace = false;
+
+        if (c == u'"' || c == u'\'') {
+            qsizetype end = i + 1;
+            while (end < size && styleSheet[end] != c) {
+                end += styleSheet[end] == u'\\' ? 2 : 1;
+            }
+            end = std::min(end + 1, size);
+            out << QStringView(styleSheet).sliced(i, end - i);
+            i = end - 1;
+            previous = c;
+            continue;
+        }
+        out << c;
+        previous = c;
+    }
+    out << '}';
 }
 
 /**
@@ -74,57 +308,1039 @@ bool MTQss::generateQssTemplate(const QString& fileName) {
 
 /**
  * @brief Imports QSS styles from a file and applies them to the application.
+ *
+ * The file is parsed in a single pass (see MTQssParser); syntax errors are reported with their line and column
+ * and the remaining rules are still applied. In MergedStyleSheet mode, the default, all rules are set as one style
+ * sheet on the parent widget, so the hierarchy is polished once per import. In PerWidgetStyleSheets mode all rules
+ * matching a widget are merged in document order, so every widget receives its style sheet once; selectors with
+ * pseudo-states, sub-controls, property selectors or combinators are kept as rules in the widget's style sheet
+ * and evaluated by Qt.
+ * If a cache directory is set, a compiled copy of the theme is reused while it is up to date.
  * @param fileName The name of the QSS file to import.
  * @return True if the import was successful, false otherwise.
  */
 bool MTQss::importQss(const QString& fileName) {
+    if (m_profiler) {
+        m_profiler->beginImport(QStringLiteral("importQss"), fileName);
+    }
+    const qint64 readStart = profileTime();
+    QByteArray source;
+    if (!readQss(fileName, source)) {
+        return false;
+    }
+    profilePhase(QStringLiteral("read"), readStart);
+
+    if (!qobject_cast<QWidget*>(parent())) {
+        qWarning() << tr("Parent widget is null. Cannot apply styles.");
+        return false;
+    }
+    cancelAsyncImport();
+    m_currentTheme.clear();
+
+    if (m_cacheDirectory.isEmpty()) {
+        const qint64 parseStart = profileTime();
+        const QList<MTQssParser::Rule> rules = parseQss(fileName, source);
+        profilePhase(QStringLiteral("parse"), parseStart);
+        applyRules(rules);
+        return true;
+    }
+
+    const QString compiledFileName = compiledFileNameFor(fileName);
+    CompiledTheme theme;
+    if (readCompiledTheme(compiledFileName, theme) && theme.sourceHash == sourceHash(source)) {
+        if (!applyCompiledTheme(theme)) {
+            writeCompiledTheme(compiledFileName, theme);
+        }
+        return true;
+    }
+
+    theme = CompiledTheme();
+    theme.sourceHash = sourceHash(source);
+    const qint64 parseStart = profileTime();
+    theme.rules = parseQss(fileName, source);
+    profilePhase(QStringLiteral("parse"), parseStart);
+    applyRules(theme.rules, &theme);
+    writeCompiledTheme(compiledFileName, theme);
+    return true;
+}
+
+/**
+ * @brief Imports QSS styles from a file without blocking the GUI thread.
+ *
+ * The file is read and parsed in the thread pool. In MergedStyleSheet mode the style sheet is set on the GUI thread
+ * in one step once parsing has finished. In PerWidgetStyleSheets mode selectors are resolved on the GUI thread and
+ * the style sheets are assigned in slices of at most applyBudget() milliseconds per event loop iteration, ancestors
+ * first; the returned future reports progress in widgets styled and can be cancelled, and widgets styled before
+ * the cancellation keep their new style sheet. A later import cancels a pending one.
+ * The compiled theme cache is not used.
+ * @param fileName The name of the QSS file to import.
+ * @return A future holding true if the import was successful.
+ */
+QFuture<bool> MTQss::importQssAsync(const QString& fileName) {
+    cancelAsyncImport();
+
+    auto promise = std::make_shared<QPromise<bool>>();
+    promise->start();
+    if (!qobject_cast<QWidget*>(parent())) {
+        qWarning() << tr("Parent widget is null. Cannot apply styles.");
+        promise->addResult(false);
+        promise->finish();
+        return promise->future();
+    }
+
+    if (m_profiler) {
+        m_profiler->beginImport(QStringLiteral("importQssAsync"), fileName);
+    }
+    const QElapsedTimer clock = m_profiler ? m_profiler->clock() : QElapsedTimer();
+    QFuture<ParsedQss> parsing = QtConcurrent::run([fileName, clock]() {
+        const auto now = [&clock]() {
+            return clock.isValid() ? clock.nsecsElapsed() : 0;
+        };
+        ParsedQss parsed;
+        parsed.readStart = now();
+        QByteArray source;
+        if (readQss(fileName, source)) {
+            parsed.parseStart = now();
+            parsed.rules = parseQss(fileName, source);
+            parsed.parseEnd = now();
+        }
+        return parsed;
+    });
+
+    // The watcher is owned by this object, so the apply step never runs after it has been destroyed
+    auto* watcher = new QFutureWatcher<ParsedQss>(this);
+    const quint64 serial = m_importSerial;
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, promise, serial]() {
+        watcher->deleteLater();
+        const ParsedQss parsed = watcher->result();
+        const std::optional<QList<MTQssParser::Rule>>& rules = parsed.rules;
+        if (serial != m_importSerial || !rules || promise->isCanceled() || !qobject_cast<QWidget*>(parent())) {
+            promise->addResult(false);
+            promise->finish();
+            return;
+        }
+        if (m_profiler) {
+            m_profiler->addPhase(QStringLiteral("read"), parsed.readStart, parsed.parseStart);
+            m_profiler->addPhase(QStringLiteral("parse"), parsed.parseStart, parsed.parseEnd);
+        }
+
+        m_currentTheme.clear();
+        if (m_applyMode == MergedStyleSheet) {
+            applyRules(*rules);
+            promise->addResult(true);
+            promise->finish();
+            return;
+        }
+
+        // Widgets styled by the previous import and not matched now are cleared in the same slices
+        const QList<WidgetStyle> styles = resolveRules(*rules);
+        QSet<QWidget*> styled;
+        styled.reserve(styles.size());
+        for (const WidgetStyle& style : styles) {
+            styled.insert(style.widget);
+        }
+        QList<WidgetStyle> pending = styles;
+        for (const QPointer<QWidget>& widget : std::as_const(m_styledWidgets)) {
+            if (widget && !styled.contains(widget)) {
+                pending.append({ widget, QString() });
+            }
+        }
+        m_styledWidgets.clear();
+        for (const WidgetStyle& style : styles) {
+            m_styledWidgets.append(style.widget);
+        }
+
+        m_pendingStyles = depthOrdered(pending);
+        m_pendingIndex = 0;
+        m_pendingPromise = promise;
+        m_polishCount = 0;
+        promise->setProgressRange(0, static_cast<int>(m_pendingStyles.size()));
+        if (!m_applyTimer) {
+            m_applyTimer = new QTimer(this);
+            m_applyTimer->setInterval(0);
+            connect(m_applyTimer, &QTimer::timeout, this, &MTQss::applyNextSlice);
+        }
+        m_applyTimer->start();
+    });
+    watcher->setFuture(parsing);
+
+    return promise->future();
+}
+
+/**
+ * @brief Sets the time importQssAsync() may spend assigning style sheets in one event loop iteration.
+ *        The default is 8 ms. At least one widget is styled per iteration.
+ */
+void MTQss::setApplyBudget(int msecs) {
+    m_applyBudget = qMax(0, msecs);
+}
+
+/**
+ * @brief Returns the time importQssAsync() may spend assigning style sheets in one event loop iteration.
+ */
+int MTQss::applyBudget() const {
+    return m_applyBudget;
+}
+
+/**
+ * @brief Enables or disables recording of styling costs.
+ *
+ * While enabled, every import, compiled import and theme switch starts a new record in profiler(): the time spent
+ * reading, parsing, resolving selectors (per rule) and applying (per widget), the polish events caused by each
+ * setStyleSheet() call, and the number of repaints of the hierarchy until the next import.
+ * @param enabled True to record, false to discard the profiler.
+ */
+void MTQss::setProfilingEnabled(bool enabled) {
+    if (enabled && !m_profiler) {
+        QWidget* parent = qobject_cast<QWidget*>(this->parent());
+        if (!parent) {
+            qWarning() << tr("Parent widget is null. Cannot profile styles.");
+            return;
+        }
+        m_profiler = new MTQssProfiler(parent, this);
+    } else if (!enabled && m_profiler) {
+        delete m_profiler;
+        m_profiler = nullptr;
+    }
+}
+
+/**
+ * @brief Returns true if styling costs are recorded.
+ */
+bool MTQss::isProfilingEnabled() const {
+    return m_profiler != nullptr;
+}
+
+/**
+ * @brief Returns the record of the last import, or nullptr if profiling is disabled.
+ */
+MTQssProfiler* MTQss::profiler() const {
+    return m_profiler;
+}
+
+/**
+ * @brief Compiles a QSS file into a binary theme for the current widget hierarchy.
+ *
+ * The compiled theme holds the parsed rules and the resolved style sheet of every widget, keyed by the widget's
+ * path in the hierarchy, together with a hash of the source text and the Qt version it was built with.
+ * @param fileName The name of the QSS file to compile.
+ * @param compiledFileName The name of the compiled theme file to write.
+ * @return True if the theme was compiled and written, false otherwise.
+ */
+bool MTQss::compileQss(const QString& fileName, const QString& compiledFileName) {
+    QByteArray source;
+    if (!readQss(fileName, source)) {
+        return false;
+    }
+
+    CompiledTheme theme;
+    theme.sourceHash = sourceHash(source);
+    theme.rules = parseQss(fileName, source);
+
+    recordResolution(resolveRules(theme.rules), theme);
+    return writeCompiledTheme(compiledFileName, theme);
+}
+
+/**
+ * @brief Applies a theme written by compileQss() without parsing any QSS.
+ *
+ * If the widget hierarchy changed since the theme was compiled, the stored rules are resolved again.
+ * @param compiledFileName The name of the compiled theme file.
+ * @return True if the theme was loaded and applied, false otherwise.
+ */
+bool MTQss::importCompiledQss(const QString& compiledFileName) {
+    if (!qobject_cast<QWidget*>(parent())) {
+        qWarning() << tr("Parent widget is null. Cannot apply styles.");
+        return false;
+    }
+
+    if (m_profiler) {
+        m_profiler->beginImport(QStringLiteral("importCompiledQss"), compiledFileName);
+    }
+    const qint64 readStart = profileTime();
+    CompiledTheme theme;
+    if (!readCompiledTheme(compiledFileName, theme)) {
+        return false;
+    }
+    profilePhase(QStringLiteral("read"), readStart);
+    cancelAsyncImport();
+    m_currentTheme.clear();
+    applyCompiledTheme(theme);
+    return true;
+}
+
+/**
+ * @brief Enables the compiled theme cache used by importQss().
+ *
+ * When set, importQss() keeps a compiled copy of every imported file in this directory and uses it while
+ * the source text, the Qt version and the widget hierarchy are unchanged. Stale entries are rebuilt.
+ * @param directory The cache directory, or an empty string to disable the cache.
+ */
+void MTQss::setCacheDirectory(const QString& directory) {
+    m_cacheDirectory = directory;
+    if (!directory.isEmpty()) {
+        QDir().mkpath(directory);
+    }
+}
+
+/**
+ * @brief Returns the compiled theme cache directory, empty if the cache is disabled.
+ */
+QString MTQss::cacheDirectory() const {
+    return m_cacheDirectory;
+}
+
+/**
+ * @brief Reads a QSS file.
+ */
+bool MTQss::readQss(const QString& fileName, QByteArray& source) {
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         qWarning() << tr("Failed to open file for reading:") << fileName;
         return false;
     }
 
-    QTextStream in(&file);
-    QString styleSheet = in.readAll();
+    source = file.readAll();
     file.close();
+    return true;
+}
+
+/**
+ * @brief Parses QSS source text and reports syntax errors with their position.
+ */
+QList<MTQssParser::Rule> MTQss::parseQss(const QString& fileName, const QByteArray& source) {
+    MTQssParser parser;
+    if (!parser.parse(QString::fromUtf8(source))) {
+        for (const MTQssParser::Error& error : parser.errors()) {
+            qWarning().noquote() << QStringLiteral("%1:%2:%3:").arg(fileName).arg(error.line).arg(error.column)
+                                 << error.message;
+        }
+    }
+    return parser.rules();
+}
+
+/**
+ * @brief Applies parsed rules in the current apply mode.
+ * @param rules The parsed rules.
+ * @param theme If not null, receives the resolved style sheets for caching.
+ */
+void MTQss::applyRules(const QList<MTQssParser::Rule>& rules, CompiledTheme* theme) {
+    if (m_applyMode == MergedStyleSheet) {
+        QString merged;
+        for (const MTQssParser::Rule& rule : rules) {
+            merged += rule.text();
+        }
+        applyStyles({ { qobject_cast<QWidget*>(parent()), merged } });
+        return;
+    }
+
+    const QList<WidgetStyle> styles = resolveRules(rules);
+    if (theme) {
+        recordResolution(styles, *theme);
+    }
+    applyStyles(styles);
+}
+
+/**
+ * @brief Stores resolved style sheets in a theme, keyed by widget path, with a hash of the current hierarchy.
+ *
+ * Identical style sheets are stored once and referenced by index.
+ */
+void MTQss::recordResolution(const QList<WidgetStyle>& styles, CompiledTheme& theme) const {
+    QHash<QWidget*, QString> styleOf;
+    for (const WidgetStyle& style : styles) {
+        styleOf.insert(style.widget, style.styleSheet);
+    }
+
+    QHash<QString, int> styleIndex;
+    QCryptographicHash hierarchy(QCryptographicHash::Md5);
+    theme.styleSheets.clear();
+    theme.widgets.clear();
+    for (const auto& [path, widget] : widgetPaths()) {
+        hierarchy.addData(path.toUtf8());
+        hierarchy.addData("\n");
+        const auto it = styleOf.constFind(widget);
+        if (it == styleOf.constEnd()) {
+            continue;
+        }
+        auto index = styleIndex.constFind(it.value());
+        if (index == styleIndex.constEnd()) {
+            index = styleIndex.insert(it.value(), static_cast<int>(theme.styleSheets.size()));
+            theme.styleSheets.append(it.value());
+        }
+        theme.widgets.append({ path, index.value() });
+    }
+    theme.hierarchyHash = hierarchy.result();
+}
+
+/**
+ * @brief Applies a compiled theme.
+ *
+ * The stored per-widget style sheets are used directly when the widget hierarchy still has the same paths;
+ * otherwise the stored rules are resolved again and the theme is updated.
+ * @return True if the stored resolution was used, false if the theme had to be resolved again.
+ */
+bool MTQss::applyCompiledTheme(CompiledTheme& theme) {
+    if (m_applyMode == PerWidgetStyleSheets && !theme.hierarchyHash.isEmpty()) {
+        const QList<QPair<QString, QWidget*>> paths = widgetPaths();
+        QCryptographicHash hierarchy(QCryptographicHash::Md5);
+        QHash<QString, QWidget*> widgetAt;
+        widgetAt.reserve(paths.size());
+        for (const auto& [path, widget] : paths) {
+            hierarchy.addData(path.toUtf8());
+            hierarchy.addData("\n");
+            widgetAt.insert(path, widget);
+        }
+
+        if (hierarchy.result() == theme.hierarchyHash) {
+            QList<WidgetStyle> styles;
+            styles.reserve(theme.widgets.size());
+            for (const auto& [path, index] : std::as_const(theme.widgets)) {
+                if (QWidget* widget = widgetAt.value(path)) {
+                    styles.append({ widget, theme.styleSheets.value(index) });
+                }
+            }
+            applyStyles(styles);
+            return true;
+        }
+    }
+
+    applyRules(theme.rules, &theme);
+    return m_applyMode == MergedStyleSheet;
+}
+
+/**
+ * @brief Returns every widget of the parent hierarchy with its path, in depth-first order.
+ *
+ * A path segment is the class name, object name and position among the siblings, so unnamed widgets
+ * have stable paths as long as the hierarchy does not change.
+ */
+QList<QPair<QString, QWidget*>> MTQss::widgetPaths() const {
+    QList<QPair<QString, QWidget*>> paths;
+    QWidget* root = qobject_cast<QWidget*>(parent());
+    if (!root) {
+        return paths;
+    }
+
+    const auto segment = [](const QWidget* widget, qsizetype position) {
+        return QString::fromLatin1(widget->metaObject()->className()) + u'#' + widget->objectName() + u'@'
+               + QString::number(position);
+    };
+    const auto collect = [&](const auto& self, QWidget* widget, const QString& path) -> void {
+        paths.append({ path, widget });
+        const QObjectList& children = widget->children();
+        for (qsizetype i = 0; i < children.size(); ++i) {
+            if (children[i]->isWidgetType()) {
+                QWidget* child = static_cast<QWidget*>(children[i]);
+                self(self, child, path + u'/' + segment(child, i));
+            }
+        }
+    };
+    collect(collect, root, segment(root, 0));
+    return paths;
+}
+
+/**
+ * @brief Returns the name of the cache file for a QSS file.
+ */
+QString MTQss::compiledFileNameFor(const QString& fileName) const {
+    const QFileInfo info(fileName);
+    const QByteArray pathHash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Md5);
+    return QDir(m_cacheDirectory).filePath(info.completeBaseName() + u'-' + QString::fromLatin1(pathHash.toHex().left(8))
+                                           + QStringLiteral(".qssc"));
+}
+
+/**
+ * @brief Returns the content hash of QSS source text.
+ */
+QByteArray MTQss::sourceHash(const QByteArray& source) {
+    return QCryptographicHash::hash(source, QCryptographicHash::Md5);
+}
+
+/**
+ * @brief Reads a compiled theme file.
+ * @return True if the file is a compiled theme of this format version and Qt version, false otherwise.
+ */
+bool MTQss::readCompiledTheme(const QString& compiledFileName, CompiledTheme& theme) {
+    QFile file(compiledFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(CompiledStreamVersion);
+    QByteArray magic;
+    quint32 formatVersion = 0;
+    QString qtVersion;
+    in >> magic >> formatVersion >> qtVersion;
+    if (magic != CompiledMagic || formatVersion != CompiledFormatVersion || qtVersion != QLatin1StringView(qVersion())) {
+        return false;
+    }
+
+    in >> theme.sourceHash;
+    readRules(in, theme.rules);
+    in >> theme.hierarchyHash >> theme.styleSheets >> theme.widgets;
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << tr("Corrupted compiled theme:") << compiledFileName;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a compiled theme file atomically.
+ */
+bool MTQss::writeCompiledTheme(const QString& compiledFileName, const CompiledTheme& theme) {
+    QSaveFile file(compiledFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << tr("Failed to open file for writing:") << compiledFileName;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(CompiledStreamVersion);
+    out << CompiledMagic << CompiledFormatVersion << QString::fromLatin1(qVersion());
+    out << theme.sourceHash;
+    writeRules(out, theme.rules);
+    out << theme.hierarchyHash << theme.styleSheets << theme.widgets;
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << tr("Failed to write compiled theme:") << compiledFileName;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads, parses and resolves a theme so that switchTheme() can apply it without file access or parsing.
+ *
+ * The style changes between the new theme and every theme preloaded before are computed here, so a switch
+ * only touches the widgets whose style sheet differs between the two themes. If the widget hierarchy changes,
+ * the preloaded themes are resolved again from their parsed rules on the next switch.
+ * @param name The name of the theme, e.g. "dark".
+ * @param fileName The name of the QSS file.
+ * @return True if the theme was loaded, false otherwise.
+ */
+bool MTQss::preloadTheme(const QString& name, const QString& fileName) {
+    QByteArray source;
+    if (!readQss(fileName, source)) {
+        return false;
+    }
+    if (!widgetIndex()) {
+        qWarning() << tr("Parent widget is null. Cannot apply styles.");
+        return false;
+    }
 
-    QWidget *parent = qobject_cast<QWidget *>(this->parent());
+    // Bring the other themes up to date first, so all of them are compared for the same hierarchy
+    refreshThemes();
 
-    if (!parent) {
+    PreloadedTheme theme;
+    theme.rules = parseQss(fileName, source);
+    resolveTheme(theme);
+    m_themes.insert(name, theme);
+    updateThemeChanges(name);
+    if (m_currentTheme == name) {
+        m_currentTheme.clear();  // The applied styles may belong to the previous version of this theme
+    }
+    return true;
+}
+
+/**
+ * @brief Applies a preloaded theme.
+ * @param name The name passed to preloadTheme().
+ * @return True if the theme was applied, false if no such theme is preloaded.
+ */
+bool MTQss::switchTheme(const QString& name) {
+    if (!m_themes.contains(name)) {
+        qWarning() << tr("Theme is not preloaded:") << name;
+        return false;
+    }
+    if (!widgetIndex()) {
         qWarning() << tr("Parent widget is null. Cannot apply styles.");
         return false;
     }
+    cancelAsyncImport();
+    if (m_profiler) {
+        m_profiler->beginImport(QStringLiteral("switchTheme"), name);
+    }
+    refreshThemes();
+
+    const PreloadedTheme& theme = m_themes[name];
+    if (m_applyMode == MergedStyleSheet) {
+        applyStyles({ { qobject_cast<QWidget*>(parent()), theme.merged } });
+    } else if (m_currentTheme.isEmpty() || !m_themes.contains(m_currentTheme)) {
+        applyStyles(theme.styles);
+    } else if (m_currentTheme != name) {
+        applyStyles(m_themeChanges.value({ m_currentTheme, name }), false);
+        m_styledWidgets.clear();
+        for (const WidgetStyle& style : theme.styles) {
+            m_styledWidgets.append(style.widget);
+        }
+    }
+    m_currentTheme = name;
+    return true;
+}
+
+/**
+ * @brief Returns the names of the preloaded themes.
+ */
+QStringList MTQss::preloadedThemes() const {
+    return m_themes.keys();
+}
+
+/**
+ * @brief Returns the name of the preloaded theme applied last, empty if another style was imported since.
+ */
+QString MTQss::currentTheme() const {
+    return m_currentTheme;
+}
+
+/**
+ * @brief Drops all preloaded themes.
+ */
+void MTQss::clearPreloadedThemes() {
+    m_themes.clear();
+    m_themeChanges.clear();
+    m_currentTheme.clear();
+}
+
+/**
+ * @brief Resolves all preloaded themes again if widgets were added, removed or renamed since they were resolved.
+ */
+void MTQss::refreshThemes() {
+    const quint64 generation = widgetIndex()->generation();
+    if (generation == m_themesGeneration) {
+        return;
+    }
+
+    for (auto it = m_themes.begin(); it != m_themes.end(); ++it) {
+        resolveTheme(it.value());
+    }
+    m_themeChanges.clear();
+    for (auto it = m_themes.cbegin(); it != m_themes.cend(); ++it) {
+        updateThemeChanges(it.key());
+    }
+    m_themesGeneration = generation;
+}
+
+/**
+ * @brief Resolves the rules of a preloaded theme for the current hierarchy.
+ */
+void MTQss::resolveTheme(PreloadedTheme& theme) {
+    theme.merged.clear();
+    for (const MTQssParser::Rule& rule : std::as_const(theme.rules)) {
+        theme.merged += rule.text();
+    }
+
+    theme.styles = resolveRules(theme.rules);
+    theme.styleOf.clear();
+    theme.styleOf.reserve(theme.styles.size());
+    for (const WidgetStyle& style : std::as_const(theme.styles)) {
+        theme.styleOf.insert(style.widget, style.styleSheet);
+    }
+}
+
+/**
+ * @brief Computes the style changes between a theme and every other preloaded theme, in both directions.
+ */
+void MTQss::updateThemeChanges(const QString& name) {
+    const PreloadedTheme& theme = m_themes[name];
+    for (auto it = m_themes.cbegin(); it != m_themes.cend(); ++it) {
+        if (it.key() != name) {
+            m_themeChanges.insert({ it.key(), name }, themeChanges(it.value(), theme));
+            m_themeChanges.insert({ name, it.key() }, themeChanges(theme, it.value()));
+        }
+    }
+}
+
+/**
+ * @brief Returns the style sheets to assign when switching from one theme to another; widgets styled only
+ *        by the first theme get an empty style sheet.
+ */
+QList<MTQss::WidgetStyle> MTQss::themeChanges(const PreloadedTheme& from, const PreloadedTheme& to) {
+    QList<WidgetStyle> changes;
+    for (const WidgetStyle& style : to.styles) {
+        const auto it = from.styleOf.constFind(style.widget);
+        if (it == from.styleOf.constEnd() || it.value() != style.styleSheet) {
+            changes.append(style);
+        }
+    }
+    for (const WidgetStyle& style : from.styles) {
+        if (!to.styleOf.contains(style.widget)) {
+            changes.append({ style.widget, QString() });
+        }
+    }
+    return changes;
+}
+
+/**
+ * @brief Sets how imported styles are assigned to widgets. The default is MergedStyleSheet.
+ */
+void MTQss::setApplyMode(ApplyMode mode) {
+    if (mode != m_applyMode) {
+        m_currentTheme.clear();  // The next switchTheme() applies the whole theme
+    }
+    m_applyMode = mode;
+}
+
+/**
+ * @brief Returns how imported styles are assigned to widgets.
+ */
+MTQss::ApplyMode MTQss::applyMode() const {
+    return m_applyMode;
+}
+
+/**
+ * @brief Returns the number of polish and style change events the parent hierarchy received
+ *        during the last import.
+ * 
+ * Only events delivered while the styles are applied are counted. Qt defers polishing a hidden widget until
+ * it is shown, so those polishes happen later and are not included.
+ */
+int MTQss::lastPolishCount() const {
+    return m_polishCount;
+}
+
+/**
+ * @brief Counts polish and style change events of the parent hierarchy while styles are applied.
+ */
+bool MTQss::eventFilter(QObject* watched, QEvent* event) {
+    if (m_countingPolish && (event->type() == QEvent::Polish || event->type() == QEvent::StyleChange)) {
+        QWidget* parent = qobject_cast<QWidget*>(this->parent());
+        QWidget* widget = qobject_cast<QWidget*>(watched);
+        if (parent && widget && (widget == parent || parent->isAncestorOf(widget))) {
+            ++m_polishCount;
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
 
-    // Parse the QSS file and handle styles
-    QRegularExpression regex(R"(#(\w+)\s*{([\s\S]*?)}|(\w+)\s*{([\s\S]*?)})");
-    QRegularExpressionMatchIterator it = regex.globalMatch(styleSheet);
+/**
+ * @brief Returns the widget index of the parent hierarchy, building it on first use.
+ */
+MTQssWidgetIndex* MTQss::widgetIndex() {
+    QWidget* parent = qobject_cast<QWidget*>(this->parent());
+    if (!m_index && parent) {
+        m_index = new MTQssWidgetIndex(parent, this);
+    }
+    return m_index;
+}
 
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
+/**
+ * @brief Matches every rule against the parent widget and its children and merges the declarations per widget.
+ *
+ * Candidates for a selector are looked up in the widget index by the object name or class of its last compound,
+ * so only those widgets are matched against the full selector.
+ * @param rules The parsed rules in document order.
+ * @return The style sheet for every matched widget, in the order the widgets were first matched.
+ */
+QList<MTQss::WidgetStyle> MTQss::resolveRules(const QList<MTQssParser::Rule>& rules) {
+    QList<WidgetStyle> styles;
+    MTQssWidgetIndex* index = widgetIndex();
+    if (!index) {
+        return styles;
+    }
 
-        QString objectName = match.captured(1); // Object-specific selector
-        QString objectStyles = match.captured(2);
-        QString className = match.captured(3); // Class-specific selector
-        QString classStyles = match.captured(4);
+    // Plain declarations and scoped rules are collected separately; a widget style sheet cannot mix bare
+    // declarations with rules, so the declarations are wrapped in a rule for the widget itself if needed
+    struct Pending {
+        QWidget* widget;
+        QString declarations;
+        QString scopedRules;
+    };
+    QList<Pending> pending;
+    QHash<QWidget*, qsizetype> pendingIndex;
 
-        if (!objectName.isEmpty()) {
-            // Special handling for parent widget (if it's identified as #TestWindow)
-            if (objectName == parent->objectName()) {
-                parent->setStyleSheet(objectStyles.trimmed());
+    const qint64 resolveStart = profileTime();
+    for (const MTQssParser::Rule& rule : rules) {
+        const qint64 ruleStart = profileTime();
+        qsizetype ruleCandidates = 0;
+        qsizetype ruleMatches = 0;
+        const QString declarations = rule.declarationsText();
+        for (const MTQssParser::Selector& selector : rule.selectors) {
+            const MTQssParser::SelectorPart& subject = selector.parts.constLast();
+            QList<QWidget*> candidates;
+            if (!subject.objectName.isEmpty()) {
+                candidates = index->widgetsByName(subject.objectName);
+            } else if (!subject.className.isEmpty() && subject.className != u"*") {
+                candidates = index->widgetsByClass(subject.className);
             } else {
-                QWidget* widget = parent->findChild<QWidget*>(objectName);
-                if (widget) {
-                    widget->setStyleSheet(objectStyles.trimmed());
+                candidates = index->widgets();
+            }
+
+            ruleCandidates += candidates.size();
+            for (QWidget* widget : std::as_const(candidates)) {
+                if (!matches(selector, widget)) {
+                    continue;
+                }
+                ++ruleMatches;
+
+                auto it = pendingIndex.constFind(widget);
+                if (it == pendingIndex.constEnd()) {
+                    it = pendingIndex.insert(widget, pending.size());
+                    pending.append({ widget, QString(), QString() });
+                }
+                Pending& target = pending[it.value()];
+                if (selector.isSimple()) {
+                    if (!target.declarations.isEmpty()) {
+                        target.declarations += u'\n';
+                    }
+                    target.declarations += declarations;
+                } else {
+                    target.scopedRules += selector.text + QStringLiteral(" {\n") + declarations + QStringLiteral("\n}\n");
                 }
             }
-        } else if (!className.isEmpty()) {
-            // Apply styles to all widgets of the given class
-            QList<QWidget*> widgets = parent->findChildren<QWidget*>(className);
-            for (QWidget* widget : widgets) {
-                widget->setStyleSheet(classStyles.trimmed());
+        }
+        if (m_profiler) {
+            QStringList selectors;
+            for (const MTQssParser::Selector& selector : rule.selectors) {
+                selectors.append(selector.text);
+            }
+            m_profiler->addRule(selectors.join(QStringLiteral(", ")), ruleStart, profileTime(), ruleCandidates,
+                                ruleMatches);
+        }
+    }
+
+    styles.reserve(pending.size());
+    for (const Pending& entry : std::as_const(pending)) {
+        QString styleSheet;
+        if (entry.scopedRules.isEmpty()) {
+            styleSheet = entry.declarations;
+        } else {
+            if (!entry.declarations.isEmpty()) {
+                bool unique = true;
+                const QString self = selfSelector(entry.widget, &unique);
+                if (!unique) {
+                    qWarning() << tr("Style declarations also apply to nested widgets of the same class:") << self;
+                }
+                styleSheet = self + QStringLiteral(" {\n") + entry.declarations + QStringLiteral("\n}\n");
+            }
+            styleSheet += entry.scopedRules;
+        }
+        styles.append({ entry.widget, styleSheet });
+    }
+    profilePhase(QStringLiteral("resolve"), resolveStart,
+                 { { QStringLiteral("rules"), qlonglong(rules.size()) },
+                   { QStringLiteral("widgets"), qlonglong(styles.size()) } });
+    return styles;
+}
+
+/**
+ * @brief Assigns the resolved style sheets with updates suspended and clears the ones left from the previous import.
+ *
+ * Ancestors are styled before their descendants and widgets whose style sheet does not change are skipped.
+ * Each setStyleSheet() call still repolishes the widget's whole subtree, so a descendant under a restyled
+ * ancestor is polished once per styled ancestor plus once for itself.
+ * @param replacePrevious If false, only the given widgets are touched and the list of styled widgets is
+ *        left to the caller, for applying the difference between two themes.
+ */
+void MTQss::applyStyles(QList<WidgetStyle> styles, bool replacePrevious) {
+    const qint64 applyStart = profileTime();
+    const QList<WidgetStyle> ordered = depthOrdered(styles);
+
+    m_polishCount = 0;
+    beginStyleUpdate();
+    if (replacePrevious) {
+        QSet<QWidget*> styled;
+        styled.reserve(ordered.size());
+        for (const WidgetStyle& style : ordered) {
+            styled.insert(style.widget);
+        }
+        for (const QPointer<QWidget>& widget : std::as_const(m_styledWidgets)) {
+            if (widget && !styled.contains(widget) && !widget->styleSheet().isEmpty()) {
+                assignStyleSheet(widget, QString());
             }
         }
+        m_styledWidgets.clear();
+    }
+    for (const WidgetStyle& style : ordered) {
+        if (style.widget->styleSheet() != style.styleSheet) {
+            assignStyleSheet(style.widget, style.styleSheet);
+        }
+        if (replacePrevious) {
+            m_styledWidgets.append(style.widget);
+        }
+    }
+    endStyleUpdate();
+    profilePhase(QStringLiteral("apply"), applyStart);
+}
+
+/**
+ * @brief Assigns pending style sheets of an asynchronous import until the apply budget is used up.
+ *
+ * Every slice suspends painting of the parent, so each event loop iteration repaints it at most once.
+ */
+void MTQss::applyNextSlice() {
+    if (!m_pendingPromise || m_pendingPromise->isCanceled()) {
+        cancelAsyncImport();
+        return;
+    }
+
+    const qint64 sliceStart = profileTime();
+    QElapsedTimer elapsed;
+    elapsed.start();
+    beginStyleUpdate();
+    while (m_pendingIndex < m_pendingStyles.size()) {
+        const WidgetStyle& style = m_pendingStyles[m_pendingIndex++];
+        if (style.widget && style.widget->styleSheet() != style.styleSheet) {
+            assignStyleSheet(style.widget, style.styleSheet);
+        }
+        if (elapsed.elapsed() >= m_applyBudget) {
+            break;
+        }
     }
+    endStyleUpdate();
+    profilePhase(QStringLiteral("apply"), sliceStart);
+    m_pendingPromise->setProgressValue(static_cast<int>(m_pendingIndex));
+
+    if (m_pendingIndex == m_pendingStyles.size()) {
+        m_applyTimer->stop();
+        m_pendingStyles.clear();
+        m_pendingPromise->addResult(true);
+        m_pendingPromise->finish();
+        m_pendingPromise.reset();
+    }
+}
+
+/**
+ * @brief Sets a widget's style sheet and reports the call to the profiler.
+ */
+void MTQss::assignStyleSheet(QWidget* widget, const QString& styleSheet) {
+    if (!m_profiler) {
+        widget->setStyleSheet(styleSheet);
+        return;
+    }
+
+    m_profiler->beginWidget(widget);
+    widget->setStyleSheet(styleSheet);
+    m_profiler->endWidget(styleSheet.size());
+}
 
+/**
+ * @brief Returns the profiler clock in nanoseconds, 0 if profiling is disabled.
+ */
+qint64 MTQss::profileTime() const {
+    return m_profiler ? m_profiler->elapsed() : 0;
+}
+
+/**
+ * @brief Records a phase that started at the given profiler time and ends now, if profiling is enabled.
+ */
+void MTQss::profilePhase(const QString& name, qint64 start, const QVariantMap& args) {
+    if (m_profiler) {
+        m_profiler->addPhase(name, start, m_profiler->elapsed(), args);
+    }
+}
+
+/**
+ * @brief Stops a pending asynchronous import; its future reports false.
+ */
+void MTQss::cancelAsyncImport() {
+    ++m_importSerial;
+    if (m_applyTimer) {
+        m_applyTimer->stop();
+    }
+    m_pendingStyles.clear();
+    m_pendingIndex = 0;
+    if (m_pendingPromise) {
+        m_pendingPromise->addResult(false);
+        m_pendingPromise->finish();
+        m_pendingPromise.reset();
+    }
+}
+
+/**
+ * @brief Returns the styles of existing widgets ordered by depth, ancestors first, keeping the order of siblings.
+ */
+QList<MTQss::WidgetStyle> MTQss::depthOrdered(const QList<WidgetStyle>& styles) {
+    QList<QPair<int, qsizetype>> order;
+    order.reserve(styles.size());
+    for (qsizetype i = 0; i < styles.size(); ++i) {
+        if (styles[i].widget) {
+            order.append({ widgetDepth(styles[i].widget), i });
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    QList<WidgetStyle> result;
+    result.reserve(order.size());
+    for (const auto& entry : std::as_const(order)) {
+        result.append(styles[entry.second]);
+    }
+    return result;
+}
+
+/**
+ * @brief Suspends painting of the parent widget and starts counting polish events.
+ *
+ * Counting stops in endStyleUpdate(). Polishes that Qt defers until a hidden widget is shown fall outside
+ * this window and are not counted.
+ */
+void MTQss::beginStyleUpdate() {
+    m_countingPolish = true;
+    QCoreApplication::instance()->installEventFilter(this);
+    if (QWidget* parent = qobject_cast<QWidget*>(this->parent())) {
+        parent->setUpdatesEnabled(false);
+    }
+}
+
+/**
+ * @brief Resumes painting, which schedules a single repaint of the parent widget, and stops counting.
+ */
+void MTQss::endStyleUpdate() {
+    if (QWidget* parent = qobject_cast<QWidget*>(this->parent())) {
+        parent->setUpdatesEnabled(true);
+    }
+    QCoreApplication::instance()->removeEventFilter(this);
+    m_countingPolish = false;
+}
+
+/**
+ * @brief Returns true if the selector's last compound matches the widget and every earlier compound
+ *        matches an ancestor as required by its combinator.
+ */
+bool MTQss::matches(const MTQssParser::Selector& selector, const QWidget* widget) {
+    qsizetype index = selector.parts.size() - 1;
+    if (index < 0 || !matchesPart(selector.parts[index], widget)) {
+        return false;
+    }
+
+    const QWidget* current = widget;
+    while (index > 0) {
+        const MTQssParser::Combinator combinator = selector.parts[index].combinator;
+        const MTQssParser::SelectorPart& ancestorPart = selector.parts[--index];
+        current = current->parentWidget();
+        if (combinator == MTQssParser::Child) {
+            if (!current || !matchesPart(ancestorPart, current)) {
+                return false;
+            }
+        } else {
+            while (current && !matchesPart(ancestorPart, current)) {
+                current = current->parentWidget();
+            }
+            if (!current) {
+                return false;
+            }
+        }
+    }
     return true;
 }
+
+/**
+ * @brief Returns true if the widget has the compound's type and object name. Pseudo-states and property
+ *        selectors depend on the widget's state and are left to Qt.
+ */
+bool MTQss::matchesPart(const MTQssParser::SelectorPart& part, const QWidget* widget) {
+    if (!part.objectName.isEmpty() && widget->objectName() != part.objectName) {
+        return false;
+    }
+    if (part.className.isEmpty() || part.className == u"*") {
+        return true;
+    }
+    if (part.exactClass) {
+        return part.className == QLatin1StringView(widget->metaObject()->className());
+    }
+    return widget->inherits(part.className.toLatin1().constData());
+}
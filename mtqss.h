@@ -1,12 +1,28 @@
 #ifndef MTQSS_H
 #define MTQSS_H
 
+#include "mtqssparser.h"
+#include "mtqsswidgetindex.h"
+
 #include <QObject>
+#include <QFuture>
+#include <QPromise>
 #include <QWidget>
+#include <QPointer>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVariantMap>
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
 
+#include <memory>
+
+class MTQssProfiler;
+class QTimer;
+
 /**
  * @class MTQss
  * @brief Handles generation, export, and import of QSS (Qt Style Sheets) files.
@@ -15,6 +31,24 @@ class MTQss : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * @brief How imported styles are assigned to widgets.
+     */
+    enum ApplyMode {
+        PerWidgetStyleSheets, ///< Every matched widget gets its own merged style sheet; each one repolishes its subtree
+        MergedStyleSheet      ///< All rules are set as one style sheet on the parent widget, polished in one pass
+    };
+
+    /**
+     * @brief Options for exportQss().
+     */
+    enum ExportOption {
+        NoExportOptions = 0x0,
+        GroupRules = 0x1, ///< Emit every distinct style once, with all selectors that share it in one selector list
+        Minify = 0x2      ///< Drop comments, indentation and optional whitespace
+    };
+    Q_DECLARE_FLAGS(ExportOptions, ExportOption)
+
     /**
      * @brief Constructs an MTQss object with a parent widget.
      * @param parent The parent widget on which the QSS operations will be performed.
@@ -23,10 +57,15 @@ public:
 
     /**
      * @brief Exports QSS styles for the given widget and its children.
+     *
+     * By default one object rule and one class rule is written per widget. With GroupRules, widgets are grouped
+     * by style text and each style is written once; a class selector appears once per distinct style.
+     * The output is streamed to the file as the widgets are visited.
      * @param fileName The name of the QSS file to export.
+     * @param options Grouping and minification options.
      * @return True if the export was successful, false otherwise.
      */
-    bool exportQss(const QString& fileName);
+    bool exportQss(const QString& fileName, ExportOptions options = NoExportOptions);
 
     /**
      * @brief Generates a default QSS file template for all widgets in the parent hierarchy.
@@ -37,12 +76,236 @@ public:
 
     /**
      * @brief Imports QSS styles from a file and applies them to the application.
+     *
+     * The file is parsed in a single pass (see MTQssParser); syntax errors are reported with their line and column
+     * and the remaining rules are still applied. In MergedStyleSheet mode, the default, all rules are set as one style
+     * sheet on the parent widget, so the hierarchy is polished once per import. In PerWidgetStyleSheets mode all rules
+     * matching a widget are merged in document order, so every widget receives its style sheet once; selectors with
+     * pseudo-states, sub-controls, property selectors or combinators are kept as rules in the widget's style sheet
+     * and evaluated by Qt.
+     * If a cache directory is set, a compiled copy of the theme is reused while it is up to date.
      * @param fileName The name of the QSS file to import.
      * @return True if the import was successful, false otherwise.
      */
     bool importQss(const QString& fileName);
 
+    /**
+     * @brief Imports QSS styles from a file without blocking the GUI thread.
+     *
+     * The file is read and parsed in the thread pool. In MergedStyleSheet mode the style sheet is set on the GUI thread
+     * in one step once parsing has finished. In PerWidgetStyleSheets mode selectors are resolved on the GUI thread and
+     * the style sheets are assigned in slices of at most applyBudget() milliseconds per event loop iteration, ancestors
+     * first; the returned future reports progress in widgets styled and can be cancelled, and widgets styled before
+     * the cancellation keep their new style sheet. A later import cancels a pending one.
+     * The compiled theme cache is not used.
+     * @param fileName The name of the QSS file to import.
+     * @return A future holding true if the import was successful.
+     */
+    QFuture<bool> importQssAsync(const QString& fileName);
+
+    /**
+     * @brief Sets the time importQssAsync() may spend assigning style sheets in one event loop iteration.
+     *        The default is 8 ms. At least one widget is styled per iteration.
+     */
+    void setApplyBudget(int msecs);
+
+    /**
+     * @brief Returns the time importQssAsync() may spend assigning style sheets in one event loop iteration.
+     */
+    int applyBudget() const;
+
+    /**
+     * @brief Enables or disables recording of styling costs.
+     *
+     * While enabled, every import, compiled import and theme switch starts a new record in profiler(): the time
+     * spent reading, parsing, resolving selectors (per rule) and applying (per widget), the polish events caused
+     * by each setStyleSheet() call, and the number of repaints of the hierarchy until the next import.
+     * @param enabled True to record, false to discard the profiler.
+     */
+    void setProfilingEnabled(bool enabled);
+
+    /**
+     * @brief Returns true if styling costs are recorded.
+     */
+    bool isProfilingEnabled() const;
+
+    /**
+     * @brief Returns the record of the last import, or nullptr if profiling is disabled.
+     */
+    MTQssProfiler* profiler() const;
+
+    /**
+     * @brief Compiles a QSS file into a binary theme for the current widget hierarchy.
+     *
+     * The compiled theme holds the parsed rules and the resolved style sheet of every widget, keyed by the widget's
+     * path in the hierarchy, together with a hash of the source text and the Qt version it was built with.
+     * @param fileName The name of the QSS file to compile.
+     * @param compiledFileName The name of the compiled theme file to write.
+     * @return True if the theme was compiled and written, false otherwise.
+     */
+    bool compileQss(const QString& fileName, const QString& compiledFileName);
+
+    /**
+     * @brief Applies a theme written by compileQss() without parsing any QSS.
+     *
+     * If the widget hierarchy changed since the theme was compiled, the stored rules are resolved again.
+     * @param compiledFileName The name of the compiled theme file.
+     * @return True if the theme was loaded and applied, false otherwise.
+     */
+    bool importCompiledQss(const QString& compiledFileName);
+
+    /**
+     * @brief Enables the compiled theme cache used by importQss().
+     *
+     * When set, importQss() keeps a compiled copy of every imported file in this directory and uses it while
+     * the source text, the Qt version and the widget hierarchy are unchanged. Stale entries are rebuilt.
+     * @param directory The cache directory, or an empty string to disable the cache.
+     */
+    void setCacheDirectory(const QString& directory);
+
+    /**
+     * @brief Returns the compiled theme cache directory, empty if the cache is disabled.
+     */
+    QString cacheDirectory() const;
+
+    /**
+     * @brief Reads, parses and resolves a theme so that switchTheme() can apply it without file access or parsing.
+     *
+     * The style changes between the new theme and every theme preloaded before are computed here, so a switch
+     * only touches the widgets whose style sheet differs between the two themes. If the widget hierarchy changes,
+     * the preloaded themes are resolved again from their parsed rules on the next switch.
+     * @param name The name of the theme, e.g. "dark".
+     * @param fileName The name of the QSS file.
+     * @return True if the theme was loaded, false otherwise.
+     */
+    bool preloadTheme(const QString& name, const QString& fileName);
+
+    /**
+     * @brief Applies a preloaded theme.
+     * @param name The name passed to preloadTheme().
+     * @return True if the theme was applied, false if no such theme is preloaded.
+     */
+    bool switchTheme(const QString& name);
+
+    /**
+     * @brief Returns the names of the preloaded themes.
+     */
+    QStringList preloadedThemes() const;
+
+    /**
+     * @brief Returns the name of the preloaded theme applied last, empty if another style was imported since.
+     */
+    QString currentTheme() const;
+
+    /**
+     * @brief Drops all preloaded themes.
+     */
+    void clearPreloadedThemes();
+
+    /**
+     * @brief Sets how imported styles are assigned to widgets. The default is MergedStyleSheet.
+     */
+    void setApplyMode(ApplyMode mode);
+
+    /**
+     * @brief Returns how imported styles are assigned to widgets.
+     */
+    ApplyMode applyMode() const;
+
+    /**
+     * @brief Returns the number of polish and style change events the parent hierarchy received
+     *        during the last import.
+     * 
+     * Only events delivered while the styles are applied are counted. Qt defers polishing a hidden widget until
+     * it is shown, so those polishes happen later and are not included.
+     */
+    int lastPolishCount() const;
+
+    /**
+     * @brief Style sheet resolved for one widget.
+     */
+    struct WidgetStyle {
+        QPointer<QWidget> widget;
+        QString styleSheet;
+    };
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    /**
+     * @brief In-memory form of a compiled theme file.
+     */
+    struct CompiledTheme {
+        QByteArray sourceHash;              ///< Hash of the QSS source text
+        QList<MTQssParser::Rule> rules;
+        QByteArray hierarchyHash;           ///< Hash of all widget paths the styles were resolved for
+        QStringList styleSheets;            ///< Distinct resolved style sheets
+        QList<QPair<QString, int>> widgets; ///< Widget path and index into styleSheets
+    };
+
+    /**
+     * @brief A parsed theme resolved for the current hierarchy.
+     */
+    struct PreloadedTheme {
+        QList<MTQssParser::Rule> rules;
+        QList<WidgetStyle> styles;         ///< Resolved style sheet of every matched widget
+        QHash<QWidget*, QString> styleOf;  ///< The same, for comparing themes
+        QString merged;                    ///< All rules as one style sheet, for MergedStyleSheet
+    };
+
+    ApplyMode m_applyMode = MergedStyleSheet;
+    QString m_cacheDirectory;
+    QHash<QString, PreloadedTheme> m_themes;
+    QHash<QPair<QString, QString>, QList<WidgetStyle>> m_themeChanges;  ///< Style changes from one theme to another
+    QString m_currentTheme;
+    quint64 m_themesGeneration = 0;  ///< Widget index generation the preloaded themes were resolved for
+    QList<QPointer<QWidget>> m_styledWidgets;  ///< Widgets that received a style sheet from the last import
+    bool m_countingPolish = false;
+    int m_polishCount = 0;
+    MTQssWidgetIndex* m_index = nullptr;       ///< Built on the first import, kept up to date afterwards
+    int m_applyBudget = 8;
+    QTimer* m_applyTimer = nullptr;            ///< Runs the slices of an asynchronous import
+    QList<WidgetStyle> m_pendingStyles;        ///< Style sheets of the asynchronous import, ancestors first
+    qsizetype m_pendingIndex = 0;              ///< Next entry of m_pendingStyles to assign
+    std::shared_ptr<QPromise<bool>> m_pendingPromise;
+    quint64 m_importSerial = 0;                ///< Changed by every import, so a superseded parse is dropped
+    MTQssProfiler* m_profiler = nullptr;
+
+    MTQssWidgetIndex* widgetIndex();
+
+    static bool readQss(const QString& fileName, QByteArray& source);
+    static QList<MTQssParser::Rule> parseQss(const QString& fileName, const QByteArray& source);
+    void applyRules(const QList<MTQssParser::Rule>& rules, CompiledTheme* theme = nullptr);
+    void recordResolution(const QList<WidgetStyle>& styles, CompiledTheme& theme) const;
+    bool applyCompiledTheme(CompiledTheme& theme);
+    QList<QPair<QString, QWidget*>> widgetPaths() const;
+    QString compiledFileNameFor(const QString& fileName) const;
+
+    static QByteArray sourceHash(const QByteArray& source);
+    static bool readCompiledTheme(const QString& compiledFileName, CompiledTheme& theme);
+    static bool writeCompiledTheme(const QString& compiledFileName, const CompiledTheme& theme);
+    QList<WidgetStyle> resolveRules(const QList<MTQssParser::Rule>& rules);
+    void applyStyles(QList<WidgetStyle> styles, bool replacePrevious = true);
+    void applyNextSlice();
+    void assignStyleSheet(QWidget* widget, const QString& styleSheet);
+    qint64 profileTime() const;
+    void profilePhase(const QString& name, qint64 start, const QVariantMap& args = QVariantMap());
+    void cancelAsyncImport();
+    static QList<WidgetStyle> depthOrdered(const QList<WidgetStyle>& styles);
+    void refreshThemes();
+    void resolveTheme(PreloadedTheme& theme);
+    void updateThemeChanges(const QString& name);
+    static QList<WidgetStyle> themeChanges(const PreloadedTheme& from, const PreloadedTheme& to);
+    void beginStyleUpdate();
+    void endStyleUpdate();
+
+    static void writeBlock(QTextStream& out, const QString& styleSheet, bool minify);
+    static bool matches(const MTQssParser::Selector& selector, const QWidget* widget);
+    static bool matchesPart(const MTQssParser::SelectorPart& part, const QWidget* widget);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(MTQss::ExportOptions)
+
 #endif // MTQSS_H
 
@@ -0,0 +1,656 @@
+#include "mtqssparser.h"
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+namespace {
+
+enum class TokenType {
+    Whitespace,
+    Ident,
+    Hash,
+    Number,
+    String,
+    Function,  ///< Identifier with its whole parenthesized argument list, e.g. url(a{b}.png)
+    Delim,
+    LeftBrace,
+    RightBrace,
+    Semicolon,
+    Colon,
+    Comma,
+    End
+};
+
+struct Token {
+    TokenType type = TokenType::End;
+    qsizetype start = 0;
+    qsizetype end = 0;
+};
+
+bool isIdentStart(QChar c) {
+    return c.isLetter() || c == u'_' || c == u'-' || c.unicode() >= 0x80;
+}
+
+bool isIdentChar(QChar c) {
+    return isIdentStart(c) || c.isDigit();
+}
+
+/**
+ * @class Tokenizer
+ * @brief Splits style sheet text into tokens on demand, with one token of lookahead.
+ *
+ * Comments are dropped; whitespace around them is reported as a single Whitespace token.
+ */
+class Tokenizer {
+public:
+    Tokenizer(QStringView text, QList<MTQssParser::Error>& errors)
+        : m_text(text)
+        , m_errors(errors) {}
+
+    Token next() {
+        if (m_peeked) {
+            return *std::exchange(m_peeked, std::nullopt);
+        }
+        return read();
+    }
+
+    const Token& peek() {
+        if (!m_peeked) {
+            m_peeked = read();
+        }
+        return *m_peeked;
+    }
+
+    QStringView text(const Token& token) const {
+        return m_text.sliced(token.start, token.end - token.start);
+    }
+
+    QChar delim(const Token& token) const {
+        return token.type == TokenType::Delim ? m_text[token.start] : QChar();
+    }
+
+    void error(qsizetype position, const QString& message) {
+        m_errors.append({ position, 0, 0, message });
+    }
+
+private:
+    QStringView m_text;
+    QList<MTQssParser::Error>& m_errors;
+    qsizetype m_pos = 0;
+    std::optional<Token> m_peeked;
+
+    QChar at(qsizetype index) const {
+        return index < m_text.size() ? m_text[index] : QChar();
+    }
+
+    /**
+     * @brief Skips whitespace and comments; returns true if any whitespace was skipped.
+     */
+    bool skipWhitespaceAndComments() {
+        bool sawWhitespace = false;
+        while (m_pos < m_text.size()) {
+            if (m_text[m_pos].isSpace()) {
+                sawWhitespace = true;
+                ++m_pos;
+            } else if (m_text[m_pos] == u'/' && at(m_pos + 1) == u'*') {
+                const qsizetype end = m_text.indexOf(u"*/", m_pos + 2);
+                if (end < 0) {
+                    error(m_pos, QCoreApplication::translate("MTQssParser", "Unterminated comment"));
+                    m_pos = m_text.size();
+                } else {
+                    m_pos = end + 2;
+                }
+            } else {
+                break;
+            }
+        }
+        return sawWhitespace;
+    }
+
+    void skipString() {
+        const QChar quote = m_text[m_pos];
+        const qsizetype start = m_pos++;
+        while (m_pos < m_text.size()) {
+            const QChar c = m_text[m_pos];
+            if (c == u'\\') {
+                m_pos += 2;
+            } else if (c == quote) {
+                ++m_pos;
+                return;
+            } else if (c == u'\n') {
+                break;
+            } else {
+                ++m_pos;
+            }
+        }
+        m_pos = std::min(m_pos, m_text.size());
+        error(start, QCoreApplication::translate("MTQssParser", "Unterminated string"));
+    }
+
+    void skipIdent() {
+        while (m_pos < m_text.size() && isIdentChar(m_text[m_pos])) {
+            ++m_pos;
+        }
+    }
+
+    /**
+     * @brief Skips a parenthesized argument list starting at '('; nested parentheses and strings are balanced.
+     */
+    void skipArguments() {
+        const qsizetype start = m_pos;
+        int depth = 0;
+        while (m_pos < m_text.size()) {
+            const QChar c = m_text[m_pos];
+            if (c == u'"' || c == u'\'') {
+                skipString();
+                continue;
+            }
+            ++m_pos;
+            if (c == u'(') {
+                ++depth;
+            } else if (c == u')' && --depth == 0) {
+                return;
+            }
+        }
+        error(start, QCoreApplication::translate("MTQssParser", "Unterminated parenthesis"));
+    }
+
+    Token read() {
+        const qsizetype start = m_pos;
+        if (skipWhitespaceAndComments()) {
+            return { TokenType::Whitespace, start, m_pos };
+        }
+        if (m_pos >= m_text.size()) {
+            return { TokenType::End, m_pos, m_pos };
+        }
+
+        const qsizetype begin = m_pos;
+        const QChar c = m_text[m_pos];
+        TokenType type = TokenType::Delim;
+        if (c == u'"' || c == u'\'') {
+            skipString();
+            type = TokenType::String;
+        } else if (c == u'#' && isIdentChar(at(m_pos + 1))) {
+            ++m_pos;
+            skipIdent();
+            type = TokenType::Hash;
+        } else if (c.isDigit() || (c == u'.' && at(m_pos + 1).isDigit())) {
+            while (m_pos < m_text.size() && (m_text[m_pos].isDigit() || m_text[m_pos] == u'.')) {
+                ++m_pos;
+            }
+            if (at(m_pos) == u'%') {
+                ++m_pos;
+            } else {
+                skipIdent();
+            }
+            type = TokenType::Number;
+        } else if (isIdentStart(c)) {
+            skipIdent();
+            type = TokenType::Ident;
+            if (at(m_pos) == u'(') {
+                skipArguments();
+                type = TokenType::Function;
+            }
+        } else {
+            ++m_pos;
+            switch (c.unicode()) {
+            case u'{':
+                type = TokenType::LeftBrace;
+                break;
+            case u'}':
+                type = TokenType::RightBrace;
+                break;
+            case u';':
+                type = TokenType::Semicolon;
+                break;
+            case u':':
+                type = TokenType::Colon;
+                break;
+            case u',':
+                type = TokenType::Comma;
+                break;
+            default:
+                break;
+            }
+        }
+        return { type, begin, m_pos };
+    }
+};
+
+/**
+ * @class Parser
+ * @brief Recursive-descent parser over the token stream.
+ */
+class Parser {
+public:
+    Parser(QStringView text, QList<MTQssParser::Rule>& rules, QList<MTQssParser::Error>& errors)
+        : m_tokens(text, errors)
+        , m_rules(rules) {}
+
+    void run() {
+        for (;;) {
+            const Token& token = m_tokens.peek();
+            if (token.type == TokenType::End) {
+                return;
+            }
+            if (token.type == TokenType::Whitespace || token.type == TokenType::Semicolon) {
+                m_tokens.next();
+            } else if (token.type == TokenType::RightBrace) {
+                m_tokens.error(token.start, QCoreApplication::translate("MTQssParser", "Unexpected '}'"));
+                m_tokens.next();
+            } else {
+                parseRule();
+            }
+        }
+    }
+
+private:
+    Tokenizer m_tokens;
+    QList<MTQssParser::Rule>& m_rules;
+
+    void parseRule() {
+        MTQssParser::Rule rule;
+        rule.position = m_tokens.peek().start;
+
+        Token failed;
+        if (!parseSelectors(rule.selectors, failed)) {
+            skipBlock(failed);
+            return;
+        }
+        if (parseDeclarations(rule.declarations, rule.position)) {
+            m_rules.append(std::move(rule));
+        }
+    }
+
+    /**
+     * @brief Parses a selector list up to and including '{'.
+     * @param failed Receives the offending token on error.
+     */
+    bool parseSelectors(QList<MTQssParser::Selector>& selectors, Token& failed) {
+        MTQssParser::Selector selector;
+        MTQssParser::SelectorPart part;
+        bool partStarted = false;
+        MTQssParser::Combinator pending = MTQssParser::NoCombinator;
+
+        // Starts a new compound if a combinator separates it from the current one
+        const auto startPart = [&]() {
+            if (!partStarted) {
+                partStarted = true;
+            } else if (pending != MTQssParser::NoCombinator) {
+                selector.parts.append(std::exchange(part, MTQssParser::SelectorPart()));
+                part.combinator = pending;
+            }
+            pending = MTQssParser::NoCombinator;
+        };
+
+        const auto finishSelector = [&](const Token& token) {
+            if (!partStarted || pending == MTQssParser::Child) {
+                m_tokens.error(token.start, QCoreApplication::translate("MTQssParser", "Empty selector"));
+                return false;
+            }
+            selector.parts.append(std::exchange(part, MTQssParser::SelectorPart()));
+            selector.text = selectorText(selector);
+            selectors.append(std::exchange(selector, MTQssParser::Selector()));
+            partStarted = false;
+            pending = MTQssParser::NoCombinator;
+            return true;
+        };
+
+        const auto fail = [&](const Token& token, const QString& message) {
+            m_tokens.error(token.start, message);
+            failed = token;
+            return false;
+        };
+
+        for (;;) {
+            const Token token = m_tokens.next();
+            const QChar delim = m_tokens.delim(token);
+            switch (token.type) {
+            case TokenType::Whitespace:
+                if (partStarted && pending == MTQssParser::NoCombinator) {
+                    pending = MTQssParser::Descendant;
+                }
+                break;
+            case TokenType::Ident:
+                if (partStarted && pending == MTQssParser::NoCombinator) {
+                    return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected type selector"));
+                }
+                startPart();
+                part.className = m_tokens.text(token).toString();
+                break;
+            case TokenType::Hash:
+                startPart();
+                part.objectName = m_tokens.text(token).sliced(1).toString();
+                break;
+            case TokenType::Colon: {
+                startPart();
+                const bool isSubControl = m_tokens.peek().type == TokenType::Colon;
+                if (isSubControl) {
+                    m_tokens.next();
+                }
+                QString prefix;
+                if (!isSubControl && m_tokens.delim(m_tokens.peek()) == u'!') {
+                    m_tokens.next();
+                    prefix = QStringLiteral("!");
+                }
+                const Token name = m_tokens.next();
+                if (name.type != TokenType::Ident) {
+                    return fail(name, QCoreApplication::translate("MTQssParser", "Expected pseudo-state or sub-control name"));
+                }
+                if (isSubControl) {
+                    part.subControl = m_tokens.text(name).toString();
+                } else {
+                    part.pseudoStates.append(prefix + m_tokens.text(name));
+                }
+                break;
+            }
+            case TokenType::LeftBrace:
+                if (!finishSelector(token)) {
+                    failed = token;
+                    return false;
+                }
+                return true;
+            case TokenType::Comma:
+                if (!finishSelector(token)) {
+                    failed = token;
+                    return false;
+                }
+                break;
+            case TokenType::End:
+                return fail(token, QCoreApplication::translate("MTQssParser", "Expected '{'"));
+            case TokenType::Delim:
+                if (delim == u'*') {
+                    if (partStarted && pending == MTQssParser::NoCombinator) {
+                        return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected type selector"));
+                    }
+                    startPart();
+                    part.className = QStringLiteral("*");
+                    break;
+                }
+                if (delim == u'.') {
+                    if (partStarted && pending == MTQssParser::NoCombinator) {
+                        return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected type selector"));
+                    }
+                    const Token name = m_tokens.next();
+                    if (name.type != TokenType::Ident) {
+                        return fail(name, QCoreApplication::translate("MTQssParser", "Expected class name after '.'"));
+                    }
+                    startPart();
+                    part.className = m_tokens.text(name).toString();
+                    part.exactClass = true;
+                    break;
+                }
+                if (delim == u'>') {
+                    if (!partStarted) {
+                        return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected '>'"));
+                    }
+                    pending = MTQssParser::Child;
+                    break;
+                }
+                if (delim == u'[') {
+                    startPart();
+                    qsizetype end = token.end;
+                    for (;;) {
+                        const Token inner = m_tokens.next();
+                        if (inner.type == TokenType::End || inner.type == TokenType::LeftBrace) {
+                            return fail(inner, QCoreApplication::translate("MTQssParser", "Unterminated property selector"));
+                        }
+                        end = inner.end;
+                        if (m_tokens.delim(inner) == u']') {
+                            break;
+                        }
+                    }
+                    part.attributes.append(m_tokens.text({ TokenType::Delim, token.start, end }).toString());
+                    break;
+                }
+                return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected '%1' in selector").arg(delim));
+            default:
+                return fail(token, QCoreApplication::translate("MTQssParser", "Unexpected '%1' in selector").arg(m_tokens.text(token)));
+            }
+        }
+    }
+
+    /**
+     * @brief Parses declarations up to and including '}'.
+     * @return False if the block was not terminated.
+     */
+    bool parseDeclarations(QList<MTQssParser::Declaration>& declarations, qsizetype rulePosition) {
+        for (;;) {
+            const Token token = m_tokens.next();
+            switch (token.type) {
+            case TokenType::Whitespace:
+            case TokenType::Semicolon:
+                continue;
+            case TokenType::RightBrace:
+                return true;
+            case TokenType::End:
+                m_tokens.error(rulePosition, QCoreApplication::translate("MTQssParser", "Unterminated block"));
+                return false;
+            case TokenType::Ident:
+                break;
+            default:
+                m_tokens.error(token.start, QCoreApplication::translate("MTQssParser", "Expected property name"));
+                if (!skipDeclaration()) {
+                    return true;
+                }
+                continue;
+            }
+
+            const QString property = m_tokens.text(token).toString();
+            skipWhitespace();
+            const Token colon = m_tokens.next();
+            if (colon.type == TokenType::End) {
+                m_tokens.error(rulePosition, QCoreApplication::translate("MTQssParser", "Unterminated block"));
+                return false;
+            }
+            if (colon.type != TokenType::Colon) {
+                m_tokens.error(colon.start, QCoreApplication::translate("MTQssParser", "Expected ':' after property '%1'").arg(property));
+                if (colon.type == TokenType::RightBrace || (colon.type != TokenType::Semicolon && !skipDeclaration())) {
+                    return true;
+                }
+                continue;
+            }
+
+            // The value is sliced from the source, so url(...), strings and colors are kept as written
+            qsizetype valueStart = -1;
+            qsizetype valueEnd = -1;
+            Token terminator;
+            for (;;) {
+                terminator = m_tokens.next();
+                if (terminator.type == TokenType::Semicolon || terminator.type == TokenType::RightBrace
+                    || terminator.type == TokenType::End) {
+                    break;
+                }
+                if (terminator.type == TokenType::LeftBrace) {
+                    m_tokens.error(terminator.start, QCoreApplication::translate("MTQssParser", "Unexpected '{' in value"));
+                    skipBlock(terminator);
+                    continue;
+                }
+                if (terminator.type != TokenType::Whitespace) {
+                    if (valueStart < 0) {
+                        valueStart = terminator.start;
+                    }
+                    valueEnd = terminator.end;
+                }
+            }
+
+            if (valueStart < 0) {
+                m_tokens.error(colon.end, QCoreApplication::translate("MTQssParser", "Empty value for property '%1'").arg(property));
+            } else {
+                declarations.append({ property, m_tokens.text({ TokenType::Ident, valueStart, valueEnd }).toString() });
+            }
+
+            if (terminator.type == TokenType::RightBrace) {
+                return true;
+            }
+            if (terminator.type == TokenType::End) {
+                m_tokens.error(rulePosition, QCoreApplication::translate("MTQssParser", "Unterminated block"));
+                return false;
+            }
+        }
+    }
+
+    void skipWhitespace() {
+        while (m_tokens.peek().type == TokenType::Whitespace) {
+            m_tokens.next();
+        }
+    }
+
+    /**
+     * @brief Skips to the end of the current declaration.
+     * @return True if the declaration ended with ';', false if the block ended.
+     */
+    bool skipDeclaration() {
+        for (;;) {
+            const Token token = m_tokens.next();
+            if (token.type == TokenType::Semicolon) {
+                return true;
+            }
+            if (token.type == TokenType::RightBrace || token.type == TokenType::End) {
+                return false;
+            }
+            if (token.type == TokenType::LeftBrace) {
+                skipBlock(token);
+            }
+        }
+    }
+
+    /**
+     * @brief Error recovery: skips past the block that follows (or was opened by) the failed token.
+     */
+    void skipBlock(const Token& failed) {
+        if (failed.type == TokenType::RightBrace || failed.type == TokenType::End) {
+            return;
+        }
+        int depth = failed.type == TokenType::LeftBrace ? 1 : 0;
+        for (;;) {
+            const Token token = m_tokens.next();
+            if (token.type == TokenType::End) {
+                return;
+            }
+            if (token.type == TokenType::LeftBrace) {
+                ++depth;
+            } else if (token.type == TokenType::RightBrace && --depth <= 0) {
+                return;
+            }
+        }
+    }
+
+    static QString selectorText(const MTQssParser::Selector& selector) {
+        QString text;
+        for (const MTQssParser::SelectorPart& part : selector.parts) {
+            if (part.combinator == MTQssParser::Descendant) {
+                text += u' ';
+            } else if (part.combinator == MTQssParser::Child) {
+                text += QStringLiteral(" > ");
+            }
+            if (part.exactClass) {
+                text += u'.';
+            }
+            text += part.className;
+            if (!part.objectName.isEmpty()) {
+                text += u'#' + part.objectName;
+            }
+            for (const QString& attribute : part.attributes) {
+                text += attribute;
+            }
+            for (const QString& state : part.pseudoStates) {
+                text += u':' + state;
+            }
+            if (!part.subControl.isEmpty()) {
+                text += QStringLiteral("::") + part.subControl;
+            }
+        }
+        return text;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Returns true if the selector only names a type and/or object, e.g. "QLabel" or "#title".
+ */
+bool MTQssParser::Selector::isSimple() const {
+    if (parts.size() != 1) {
+        return false;
+    }
+    const SelectorPart& part = parts.first();
+    return !part.exactClass && part.attributes.isEmpty() && part.pseudoStates.isEmpty() && part.subControl.isEmpty();
+}
+
+/**
+ * @brief Returns the declarations as style sheet text, "property: value;" per line.
+ */
+QString MTQssParser::Rule::declarationsText() const {
+    QString text;
+    for (const Declaration& declaration : declarations) {
+        if (!text.isEmpty()) {
+            text += u'\n';
+        }
+        text += declaration.property + QStringLiteral(": ") + declaration.value + u';';
+    }
+    return text;
+}
+
+/**
+ * @brief Returns the whole rule as style sheet text.
+ */
+QString MTQssParser::Rule::text() const {
+    QString result;
+    for (const Selector& selector : selectors) {
+        if (!result.isEmpty()) {
+            result += QStringLiteral(", ");
+        }
+        result += selector.text;
+    }
+    return result + QStringLiteral(" {\n") + declarationsText() + QStringLiteral("\n}\n");
+}
+
+/**
+ * @brief Parses a style sheet. Previous results are discarded.
+ * @param text The style sheet text.
+ * @return True if the text was parsed without errors, false otherwise. Rules parsed before and after
+ *         an error are still available from rules().
+ */
+bool MTQssParser::parse(QStringView text) {
+    m_rules.clear();
+    m_errors.clear();
+
+    Parser(text, m_rules, m_errors).run();
+
+    // Errors are reported roughly in source order; resolve line and column in one pass over the text
+    std::stable_sort(m_errors.begin(), m_errors.end(), [](const Error& a, const Error& b) {
+        return a.position < b.position;
+    });
+    int line = 1;
+    qsizetype lineStart = 0;
+    qsizetype scanned = 0;
+    for (Error& error : m_errors) {
+        for (; scanned < error.position && scanned < text.size(); ++scanned) {
+            if (text[scanned] == u'\n') {
+                ++line;
+                lineStart = scanned + 1;
+            }
+        }
+        error.line = line;
+        error.column = static_cast<int>(error.position - lineStart) + 1;
+    }
+
+    return m_errors.isEmpty();
+}
+
+/**
+ * @brief Returns the rules of the last parse in document order.
+ */
+const QList<MTQssParser::Rule>& MTQssParser::rules() const {
+    return m_rules;
+}
+
+/**
+ * @brief Returns the syntax errors of the last parse.
+ */
+const QList<MTQssParser::Error>& MTQssParser::errors() const {
+    return m_errors;
+}
@@ -0,0 +1,115 @@
+#ifndef MTQSSPARSER_H
+#define MTQSSPARSER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @class MTQssParser
+ * @brief Single-pass tokenizer and parser for Qt Style Sheets.
+ *
+ * The text is tokenized and parsed in one linear scan into a list of rules, each with its selector list
+ * and declarations. Comments, strings and parenthesized values such as url(...) are handled by the tokenizer,
+ * so braces and semicolons inside them do not end a block. Syntax errors are recorded with their position and
+ * the parser recovers at the next rule, so one broken rule does not discard the rest of the file.
+ */
+class MTQssParser {
+public:
+    /**
+     * @brief How a compound selector is related to the one before it.
+     */
+    enum Combinator {
+        NoCombinator,  ///< First compound of the selector
+        Descendant,    ///< "A B": any ancestor
+        Child          ///< "A > B": direct parent
+    };
+
+    /**
+     * @brief One compound selector, e.g. QPushButton#ok:hover:!pressed.
+     */
+    struct SelectorPart {
+        QString className;          ///< Type selector, empty or "*" for any widget
+        bool exactClass = false;    ///< True for ".QPushButton", which does not match subclasses
+        QString objectName;         ///< ID selector without "#"
+        QStringList attributes;     ///< Property selectors with brackets, e.g. [flat="true"]
+        QStringList pseudoStates;   ///< Pseudo-states without ":", negated ones keep their "!"
+        QString subControl;         ///< Sub-control without "::", e.g. "drop-down"
+        Combinator combinator = NoCombinator;
+    };
+
+    /**
+     * @brief A complex selector, the compounds in document order.
+     */
+    struct Selector {
+        QList<SelectorPart> parts;
+        QString text;  ///< Normalized source text of the selector
+
+        /**
+         * @brief Returns true if the selector only names a type and/or object, e.g. "QLabel" or "#title".
+         */
+        bool isSimple() const;
+    };
+
+    /**
+     * @brief A property declaration; the value is kept as written.
+     */
+    struct Declaration {
+        QString property;
+        QString value;
+    };
+
+    /**
+     * @brief A rule: selector list and declaration block.
+     */
+    struct Rule {
+        QList<Selector> selectors;
+        QList<Declaration> declarations;
+        qsizetype position = 0;  ///< Offset of the rule in the source text
+
+        /**
+         * @brief Returns the declarations as style sheet text, "property: value;" per line.
+         */
+        QString declarationsText() const;
+
+        /**
+         * @brief Returns the whole rule as style sheet text.
+         */
+        QString text() const;
+    };
+
+    /**
+     * @brief A syntax error.
+     */
+    struct Error {
+        qsizetype position = 0;  ///< Offset in the source text
+        int line = 0;            ///< 1-based line
+        int column = 0;          ///< 1-based column
+        QString message;
+    };
+
+    /**
+     * @brief Parses a style sheet. Previous results are discarded.
+     * @param text The style sheet text.
+     * @return True if the text was parsed without errors, false otherwise. Rules parsed before and after
+     *         an error are still available from rules().
+     */
+    bool parse(QStringView text);
+
+    /**
+     * @brief Returns the rules of the last parse in document order.
+     */
+    const QList<Rule>& rules() const;
+
+    /**
+     * @brief Returns the syntax errors of the last parse.
+     */
+    const QList<Error>& errors() const;
+
+private:
+    QList<Rule> m_rules;
+    QList<Error> m_errors;
+};
+
+#endif // MTQSSPARSER_H
@@ -0,0 +1,243 @@
+#include "mtqssprofiler.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <algorithm>
+
+/**
+ * @brief Constructs a profiler for a widget hierarchy.
+ * @param root The root of the profiled hierarchy.
+ * @param parent The QObject parent.
+ */
+MTQssProfiler::MTQssProfiler(QWidget* root, QObject* parent)
+    : QObject(parent)
+    , m_root(root) {}
+
+/**
+ * @brief Discards the previous record and starts a new one.
+ * @param name The name of the import, e.g. "importQss".
+ * @param source The imported file.
+ */
+void MTQssProfiler::beginImport(const QString& name, const QString& source) {
+    m_name = name;
+    m_source = source;
+    m_events.clear();
+    m_repaints = 0;
+    m_widget = nullptr;
+    m_clock.start();
+
+    // Installing again moves the filter to the front; it is removed when the profiler is destroyed
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+/**
+ * @brief Returns the time since beginImport() in nanoseconds.
+ */
+qint64 MTQssProfiler::elapsed() const {
+    return m_clock.isValid() ? m_clock.nsecsElapsed() : 0;
+}
+
+/**
+ * @brief Returns the clock of the current record; a copy may be read on another thread.
+ */
+QElapsedTimer MTQssProfiler::clock() const {
+    return m_clock;
+}
+
+/**
+ * @brief Records a phase of the import.
+ * @param name The phase, e.g. "parse".
+ * @param start The start time from elapsed().
+ * @param end The end time from elapsed().
+ * @param args Additional values shown with the phase.
+ */
+void MTQssProfiler::addPhase(const QString& name, qint64 start, qint64 end, const QVariantMap& args) {
+    m_events.append({ name, QStringLiteral("phase"), start, end - start, args });
+}
+
+/**
+ * @brief Records the resolution cost of one rule.
+ * @param selector The selector list of the rule.
+ * @param start The start time from elapsed().
+ * @param end The end time from elapsed().
+ * @param candidates The number of widgets matched against the selectors.
+ * @param matched The number of widgets the rule applies to.
+ */
+void MTQssProfiler::addRule(const QString& selector, qint64 start, qint64 end, qsizetype candidates, qsizetype matched) {
+    m_events.append({ selector, QStringLiteral("rule"), start, end - start,
+                      { { QStringLiteral("candidates"), qlonglong(candidates) },
+                        { QStringLiteral("matched"), qlonglong(matched) } } });
+}
+
+/**
+ * @brief Marks the start of a setStyleSheet() call; polish events until endWidget() are attributed to it.
+ */
+void MTQssProfiler::beginWidget(QWidget* widget) {
+    m_widget = widget;
+    m_widgetPolishes = 0;
+    m_widgetStart = elapsed();
+}
+
+/**
+ * @brief Records the setStyleSheet() call started by beginWidget().
+ * @param styleSheetSize The length of the assigned style sheet.
+ */
+void MTQssProfiler::endWidget(qsizetype styleSheetSize) {
+    const qint64 end = elapsed();
+    m_events.append({ describe(m_widget), QStringLiteral("style"), m_widgetStart, end - m_widgetStart,
+                      { { QStringLiteral("polishEvents"), m_widgetPolishes },
+                        { QStringLiteral("styleSheetSize"), qlonglong(styleSheetSize) } } });
+    m_widget = nullptr;
+}
+
+/**
+ * @brief Returns the number of paint events the hierarchy received since beginImport().
+ */
+int MTQssProfiler::repaintCount() const {
+    return m_repaints;
+}
+
+/**
+ * @brief Returns the total time of all phases with the given name in nanoseconds.
+ */
+qint64 MTQssProfiler::phaseTime(const QString& name) const {
+    qint64 total = 0;
+    for (const Event& event : m_events) {
+        if (event.category == u"phase" && event.name == name) {
+            total += event.duration;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Returns the record as JSON.
+ */
+QByteArray MTQssProfiler::toJson(Format format) const {
+    const auto micros = [](qint64 nsecs) {
+        return nsecs / 1000.0;
+    };
+
+    qint64 end = 0;
+    for (const Event& event : m_events) {
+        end = qMax(end, event.start + qMax<qint64>(event.duration, 0));
+    }
+
+    if (format == ChromeTrace) {
+        QJsonArray traceEvents;
+        traceEvents.append(QJsonObject{ { "name", m_name }, { "cat", "import" }, { "ph", "X" }, { "ts", 0 },
+                                        { "dur", micros(end) }, { "pid", 1 }, { "tid", 1 },
+                                        { "args", QJsonObject{ { "source", m_source }, { "repaints", m_repaints } } } });
+        for (const Event& event : m_events) {
+            QJsonObject object{ { "name", event.name }, { "cat", event.category }, { "ts", micros(event.start) },
+                                { "pid", 1 }, { "tid", 1 }, { "args", QJsonObject::fromVariantMap(event.args) } };
+            if (event.duration < 0) {
+                object.insert("ph", "i");
+                object.insert("s", "t");
+            } else {
+                object.insert("ph", "X");
+                object.insert("dur", micros(event.duration));
+            }
+            traceEvents.append(object);
+        }
+        return QJsonDocument(QJsonObject{ { "traceEvents", traceEvents }, { "displayTimeUnit", "ms" } }).toJson();
+    }
+
+    QList<const Event*> rules;
+    QList<const Event*> widgets;
+    QJsonObject phases;
+    for (const Event& event : m_events) {
+        if (event.category == u"rule") {
+            rules.append(&event);
+        } else if (event.category == u"style") {
+            widgets.append(&event);
+        } else if (event.category == u"phase") {
+            phases.insert(event.name, phases.value(event.name).toDouble() + micros(event.duration) / 1000.0);
+        }
+    }
+    const auto slowestFirst = [](const Event* a, const Event* b) {
+        return a->duration > b->duration;
+    };
+    std::stable_sort(rules.begin(), rules.end(), slowestFirst);
+    std::stable_sort(widgets.begin(), widgets.end(), slowestFirst);
+
+    const auto toArray = [&micros](const QList<const Event*>& events, const char* key) {
+        QJsonArray array;
+        for (const Event* event : events) {
+            QJsonObject object = QJsonObject::fromVariantMap(event->args);
+            object.insert(key, event->name);
+            object.insert("us", micros(event->duration));
+            array.append(object);
+        }
+        return array;
+    };
+
+    return QJsonDocument(QJsonObject{ { "import", m_name },
+                                      { "source", m_source },
+                                      { "totalMs", micros(end) / 1000.0 },
+                                      { "phasesMs", phases },
+                                      { "repaints", m_repaints },
+                                      { "rules", toArray(rules, "selector") },
+                                      { "widgets", toArray(widgets, "widget") } })
+        .toJson();
+}
+
+/**
+ * @brief Writes the record to a file.
+ * @param fileName The name of the file.
+ * @param format The output format.
+ * @return True if the file was written, false otherwise.
+ */
+bool MTQssProfiler::save(const QString& fileName, Format format) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << tr("Failed to open file for writing:") << fileName;
+        return false;
+    }
+
+    if (file.write(toJson(format)) < 0) {
+        qWarning() << tr("Failed to write file:") << fileName;
+        return false;
+    }
+    file.close();
+    return true;
+}
+
+/**
+ * @brief Counts paint events and attributes polish events of the profiled hierarchy.
+ */
+bool MTQssProfiler::eventFilter(QObject* watched, QEvent* event) {
+    const QEvent::Type type = event->type();
+    if ((type == QEvent::Paint || type == QEvent::Polish || type == QEvent::StyleChange) && inHierarchy(watched)) {
+        if (type == QEvent::Paint) {
+            ++m_repaints;
+        } else if (m_widget) {
+            ++m_widgetPolishes;
+        } else if (type == QEvent::Polish) {
+            // Hidden widgets are polished when they are shown, long after their style sheet was set
+            m_events.append({ describe(static_cast<QWidget*>(watched)), QStringLiteral("polish"), elapsed(), -1, {} });
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool MTQssProfiler::inHierarchy(QObject* object) const {
+    QWidget* widget = qobject_cast<QWidget*>(object);
+    return m_root && widget && (widget == m_root || m_root->isAncestorOf(widget));
+}
+
+/**
+ * @brief Returns "Class#objectName", or the class alone for unnamed widgets.
+ */
+QString MTQssProfiler::describe(const QWidget* widget) {
+    if (!widget) {
+        return QStringLiteral("(deleted)");
+    }
+    const QString className = QString::fromLatin1(widget->metaObject()->className());
+    return widget->objectName().isEmpty() ? className : className + u'#' + widget->objectName();
+}
@@ -0,0 +1,139 @@
+#ifndef MTQSSPROFILER_H
+#define MTQSSPROFILER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QVariantMap>
+#include <QWidget>
+
+/**
+ * @class MTQssProfiler
+ * @brief Records where the time of one style sheet import goes.
+ *
+ * MTQss reports its phases (reading, parsing, selector resolution, applying), the cost of every rule during
+ * resolution and the duration of every setStyleSheet() call. The profiler itself watches the application's events
+ * for the widget hierarchy: Polish and StyleChange events are attributed to the widget being styled at the time,
+ * and Paint events are counted until the next import starts. All times are in nanoseconds since beginImport().
+ */
+class MTQssProfiler : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Output formats of toJson() and save().
+     */
+    enum Format {
+        Summary,     ///< Phase totals, repaint count, and rules and widgets sorted by cost
+        ChromeTrace  ///< Trace Event Format, for chrome://tracing or Perfetto
+    };
+
+    /**
+     * @brief Constructs a profiler for a widget hierarchy.
+     * @param root The root of the profiled hierarchy.
+     * @param parent The QObject parent.
+     */
+    explicit MTQssProfiler(QWidget* root, QObject* parent = nullptr);
+
+    /**
+     * @brief Discards the previous record and starts a new one.
+     * @param name The name of the import, e.g. "importQss".
+     * @param source The imported file.
+     */
+    void beginImport(const QString& name, const QString& source);
+
+    /**
+     * @brief Returns the time since beginImport() in nanoseconds.
+     */
+    qint64 elapsed() const;
+
+    /**
+     * @brief Returns the clock of the current record; a copy may be read on another thread.
+     */
+    QElapsedTimer clock() const;
+
+    /**
+     * @brief Records a phase of the import.
+     * @param name The phase, e.g. "parse".
+     * @param start The start time from elapsed().
+     * @param end The end time from elapsed().
+     * @param args Additional values shown with the phase.
+     */
+    void addPhase(const QString& name, qint64 start, qint64 end, const QVariantMap& args = QVariantMap());
+
+    /**
+     * @brief Records the resolution cost of one rule.
+     * @param selector The selector list of the rule.
+     * @param start The start time from elapsed().
+     * @param end The end time from elapsed().
+     * @param candidates The number of widgets matched against the selectors.
+     * @param matched The number of widgets the rule applies to.
+     */
+    void addRule(const QString& selector, qint64 start, qint64 end, qsizetype candidates, qsizetype matched);
+
+    /**
+     * @brief Marks the start of a setStyleSheet() call; polish events until endWidget() are attributed to it.
+     */
+    void beginWidget(QWidget* widget);
+
+    /**
+     * @brief Records the setStyleSheet() call started by beginWidget().
+     * @param styleSheetSize The length of the assigned style sheet.
+     */
+    void endWidget(qsizetype styleSheetSize);
+
+    /**
+     * @brief Returns the number of paint events the hierarchy received since beginImport().
+     */
+    int repaintCount() const;
+
+    /**
+     * @brief Returns the total time of all phases with the given name in nanoseconds.
+     */
+    qint64 phaseTime(const QString& name) const;
+
+    /**
+     * @brief Returns the record as JSON.
+     */
+    QByteArray toJson(Format format) const;
+
+    /**
+     * @brief Writes the record to a file.
+     * @param fileName The name of the file.
+     * @param format The output format.
+     * @return True if the file was written, false otherwise.
+     */
+    bool save(const QString& fileName, Format format) const;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    /**
+     * @brief One recorded interval or instant.
+     */
+    struct Event {
+        QString name;
+        QString category;  ///< "import", "phase", "rule", "style" or "polish"
+        qint64 start = 0;
+        qint64 duration = -1;  ///< -1 for an instant event
+        QVariantMap args;
+    };
+
+    QPointer<QWidget> m_root;
+    QElapsedTimer m_clock;
+    QString m_name;
+    QString m_source;
+    QList<Event> m_events;
+    int m_repaints = 0;
+    QPointer<QWidget> m_widget;  ///< Widget inside setStyleSheet(), if any
+    qint64 m_widgetStart = 0;
+    int m_widgetPolishes = 0;
+
+    bool inHierarchy(QObject* object) const;
+    static QString describe(const QWidget* widget);
+};
+
+#endif // MTQSSPROFILER_H
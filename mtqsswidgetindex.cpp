@@ -0,0 +1,207 @@
+#include "mtqsswidgetindex.h"
+#include <QChildEvent>
+#include <QEvent>
+
+#include <utility>
+
+/**
+ * @brief Constructs an index of root and all its descendants.
+ * @param root The root of the indexed hierarchy.
+ * @param parent The QObject parent.
+ */
+MTQssWidgetIndex::MTQssWidgetIndex(QWidget* root, QObject* parent)
+    : QObject(parent)
+    , m_root(root) {
+    if (root) {
+        addSubtree(root);
+    }
+}
+
+/**
+ * @brief Returns the indexed root widget.
+ */
+QWidget* MTQssWidgetIndex::root() const {
+    return m_root;
+}
+
+/**
+ * @brief Returns the widgets with the given object name.
+ */
+QList<QWidget*> MTQssWidgetIndex::widgetsByName(const QString& objectName) {
+    ensureIndexed();
+    const QSet<QWidget*> widgets = m_byName.value(objectName);
+    return QList<QWidget*>(widgets.cbegin(), widgets.cend());
+}
+
+/**
+ * @brief Returns the widgets that are instances of the class or inherit from it.
+ */
+QList<QWidget*> MTQssWidgetIndex::widgetsByClass(const QString& className) {
+    ensureIndexed();
+    const QSet<QWidget*> widgets = m_byClass.value(className);
+    return QList<QWidget*>(widgets.cbegin(), widgets.cend());
+}
+
+/**
+ * @brief Returns all indexed widgets, the root included.
+ */
+QList<QWidget*> MTQssWidgetIndex::widgets() {
+    ensureIndexed();
+    QList<QWidget*> result;
+    result.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        result.append(static_cast<QWidget*>(it.key()));
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the number of indexed widgets.
+ */
+qsizetype MTQssWidgetIndex::size() {
+    ensureIndexed();
+    return m_entries.size();
+}
+
+/**
+ * @brief Returns a counter that changes whenever a widget is added, removed or renamed.
+ */
+quint64 MTQssWidgetIndex::generation() {
+    ensureIndexed();
+    return m_generation;
+}
+
+/**
+ * @brief Queues added children and drops removed ones from the index.
+ */
+bool MTQssWidgetIndex::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::ChildAdded) {
+        QObject* child = static_cast<QChildEvent*>(event)->child();
+        if (child->isWidgetType()) {
+            m_pending.append(child);
+        }
+    } else if (event->type() == QEvent::ChildRemoved) {
+        // The child may be in its destructor; it is only used as a key
+        removeSubtree(static_cast<QChildEvent*>(event)->child());
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+/**
+ * @brief Indexes the children queued by ChildAdded that still belong to the hierarchy.
+ */
+void MTQssWidgetIndex::ensureIndexed() {
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    const QList<QPointer<QObject>> pending = std::exchange(m_pending, {});
+    for (const QPointer<QObject>& object : pending) {
+        QWidget* widget = qobject_cast<QWidget*>(object.data());
+        if (widget && m_root && (widget == m_root || m_root->isAncestorOf(widget)) && !m_entries.contains(widget)) {
+            addSubtree(widget);
+        }
+    }
+}
+
+void MTQssWidgetIndex::addSubtree(QWidget* widget) {
+    addWidget(widget);
+    const QList<QWidget*> children = widget->findChildren<QWidget*>();
+    for (QWidget* child : children) {
+        addWidget(child);
+    }
+}
+
+void MTQssWidgetIndex::addWidget(QWidget* widget) {
+    if (m_entries.contains(widget)) {
+        return;
+    }
+
+    Entry entry;
+    entry.objectName = widget->objectName();
+    for (const QMetaObject* meta = widget->metaObject(); meta; meta = meta->superClass()) {
+        entry.classNames.append(QString::fromLatin1(meta->className()));
+    }
+
+    // Unnamed widgets are never looked up by name; most widgets are unnamed
+    if (!entry.objectName.isEmpty()) {
+        m_byName[entry.objectName].insert(widget);
+    }
+    for (const QString& className : std::as_const(entry.classNames)) {
+        m_byClass[className].insert(widget);
+    }
+    m_entries.insert(widget, entry);
+    ++m_generation;
+
+    widget->installEventFilter(this);
+    connect(widget, &QObject::objectNameChanged, this, [this, widget](const QString& objectName) {
+        rename(widget, objectName);
+    });
+    connect(widget, &QObject::destroyed, this, [this](QObject* object) {
+        removeWidget(object);
+    });
+}
+
+/**
+ * @brief Removes an object and every indexed widget below it.
+ */
+void MTQssWidgetIndex::removeSubtree(QObject* object) {
+    if (!m_entries.contains(object)) {
+        return;
+    }
+    removeWidget(object);
+
+    // Descendants of a deleted widget are destroyed, and removed, before it, so this only finds reparented subtrees
+    const QList<QObject*> descendants = object->findChildren<QObject*>();
+    for (QObject* descendant : descendants) {
+        removeWidget(descendant);
+    }
+}
+
+void MTQssWidgetIndex::removeWidget(QObject* object) {
+    const auto it = m_entries.constFind(object);
+    if (it == m_entries.constEnd()) {
+        return;
+    }
+
+    QWidget* widget = static_cast<QWidget*>(object);
+    const auto removeFrom = [widget](QHash<QString, QSet<QWidget*>>& table, const QString& key) {
+        const auto found = table.find(key);
+        if (found != table.end()) {
+            found->remove(widget);
+            if (found->isEmpty()) {
+                table.erase(found);
+            }
+        }
+    };
+    removeFrom(m_byName, it->objectName);
+    for (const QString& className : it->classNames) {
+        removeFrom(m_byClass, className);
+    }
+    m_entries.erase(it);
+    ++m_generation;
+
+    // Connections to a destroyed object are dropped by Qt; a reparented one is indexed again if it comes back
+    object->removeEventFilter(this);
+    disconnect(object, nullptr, this, nullptr);
+}
+
+void MTQssWidgetIndex::rename(QWidget* widget, const QString& objectName) {
+    const auto it = m_entries.find(widget);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    const auto found = m_byName.find(it->objectName);
+    if (found != m_byName.end()) {
+        found->remove(widget);
+        if (found->isEmpty()) {
+            m_byName.erase(found);
+        }
+    }
+    it->objectName = objectName;
+    if (!objectName.isEmpty()) {
+        m_byName[objectName].insert(widget);
+    }
+    ++m_generation;
+}
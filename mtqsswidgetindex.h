@@ -0,0 +1,87 @@
+#ifndef MTQSSWIDGETINDEX_H
+#define MTQSSWIDGETINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QWidget>
+
+/**
+ * @class MTQssWidgetIndex
+ * @brief Lookup tables from object names and class names to the widgets of a hierarchy.
+ *
+ * Every named widget is registered under its object name, and every widget under the class names of its whole
+ * meta-object chain, so a type selector also finds subclasses. The index follows the hierarchy through ChildAdded and ChildRemoved
+ * events and objectNameChanged(). Added widgets may still be under construction when ChildAdded arrives,
+ * so they are only queued and indexed on the next lookup.
+ */
+class MTQssWidgetIndex : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an index of root and all its descendants.
+     * @param root The root of the indexed hierarchy.
+     * @param parent The QObject parent.
+     */
+    explicit MTQssWidgetIndex(QWidget* root, QObject* parent = nullptr);
+
+    /**
+     * @brief Returns the indexed root widget.
+     */
+    QWidget* root() const;
+
+    /**
+     * @brief Returns the widgets with the given object name.
+     */
+    QList<QWidget*> widgetsByName(const QString& objectName);
+
+    /**
+     * @brief Returns the widgets that are instances of the class or inherit from it.
+     */
+    QList<QWidget*> widgetsByClass(const QString& className);
+
+    /**
+     * @brief Returns all indexed widgets, the root included.
+     */
+    QList<QWidget*> widgets();
+
+    /**
+     * @brief Returns the number of indexed widgets.
+     */
+    qsizetype size();
+
+    /**
+     * @brief Returns a counter that changes whenever a widget is added, removed or renamed.
+     */
+    quint64 generation();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    struct Entry {
+        QString objectName;
+        QStringList classNames;
+    };
+
+    QPointer<QWidget> m_root;
+    QHash<QObject*, Entry> m_entries;
+    QHash<QString, QSet<QWidget*>> m_byName;
+    QHash<QString, QSet<QWidget*>> m_byClass;
+    QList<QPointer<QObject>> m_pending;  ///< Children added since the last lookup
+    quint64 m_generation = 0;
+
+    void ensureIndexed();
+    void addSubtree(QWidget* widget);
+    void addWidget(QWidget* widget);
+    void removeSubtree(QObject* object);
+    void removeWidget(QObject* object);
+    void rename(QWidget* widget, const QString& objectName);
+};
+
+#endif // MTQSSWIDGETINDEX_H
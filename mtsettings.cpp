@@ -1,131 +1,2140 @@
 #include "mtsettings.h"
+#include "mtsettingssnapshot.h"
+#include "mtgzipdevice.h"
 #include <QFile>
 #include <QTextStream>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QDomDocument>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+#include <QTemporaryFile>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QDebug>
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr qint64 ProgressInterval = 256;  ///< Keys processed between two progress callbacks
+constexpr int ProgressRange = 1000;       ///< Async progress is reported in per mille, whatever the unit of the work
+constexpr QDataStream::Version DeltaStreamVersion = QDataStream::Qt_6_5;
+constexpr qsizetype CopyChunkSize = 64 * 1024;
+constexpr qsizetype FanOutBatchSize = 4096;  ///< Keys read per batch when fan-out writers run in parallel
+
+/**
+ * @brief Converts a position in keys or bytes to per mille of ProgressRange.
+ *
+ * Byte offsets of large files do not fit into the int range of QFuture progress.
+ */
+int progressPerMille(qint64 done, qint64 total) {
+    return total > 0 ? static_cast<int>(std::clamp<qint64>(done * ProgressRange / total, 0, ProgressRange)) : ProgressRange;
+}
+
+/**
+ * @brief Maps the whole file into memory, falling back to reading it when mapping is not possible.
+ * @param file An open file.
+ * @return The file contents; a mapped buffer stays valid until the file is closed.
+ */
+QByteArray mapFile(QFile& file) {
+    const qint64 size = file.size();
+    if (size > 0) {
+        if (uchar* data = file.map(0, size)) {
+            return QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+        }
+    }
+    return file.readAll();
+}
+
+/**
+ * @brief Appends a quoted and escaped JSON string to the buffer.
+ * @param out The output buffer.
+ * @param text The text to append.
+ */
+void appendJsonString(QByteArray& out, QStringView text) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    out += '"';
+    const QByteArray utf8 = text.toUtf8();
+    for (const char c : utf8) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<uchar>(c) < 0x20) {
+                out += "\\u00";
+                out += hexDigits[(c >> 4) & 0xf];
+                out += hexDigits[c & 0xf];
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Returns the value of a hexadecimal digit, or -1 if the character is not one.
+ */
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @class ByteInput
+ * @brief Byte source of the pull parsers: a whole in-memory or mapped buffer, or a device read chunk by chunk.
+ *
+ * With a device, only the record being parsed and the unread rest of the last chunk are kept in memory.
+ * Positions stay valid while a record is parsed; discardConsumed() drops the bytes before it between records.
+ */
+class ByteInput {
+public:
+    /**
+     * @brief Constructs an input over a buffer, or over a device if one is given.
+     * @param data The whole input, used when device is null.
+     * @param device A device open for reading, e.g. an inflating MTGzipDevice.
+     */
+    ByteInput(QByteArrayView data, QIODevice* device)
+        : m_data(device ? QByteArrayView() : data)
+        , m_device(device) {}
+
+    /**
+     * @brief Returns the number of bytes parsed so far.
+     */
+    qsizetype position() const { return m_discarded + m_pos; }
+
+protected:
+    QByteArrayView m_data;
+    qsizetype m_pos = 0;
+
+    /**
+     * @brief Returns true if count bytes are available at the current position, reading more from the device if needed.
+     */
+    bool available(qsizetype count = 1) {
+        while (m_pos + count > m_data.size() && m_device) {
+            const QByteArray chunk = m_device->read(CopyChunkSize);
+            if (chunk.isEmpty()) {
+                m_device = nullptr;  // End of the stream or a read error, checked by the caller
+                break;
+            }
+            m_buffer += chunk;
+            m_data = m_buffer;
+        }
+        return m_pos + count <= m_data.size();
+    }
+
+    /**
+     * @brief Drops the parsed bytes from the device buffer once they make up a whole chunk.
+     */
+    void discardConsumed() {
+        if (m_buffer.isEmpty() || m_pos < CopyChunkSize) {
+            return;
+        }
+        m_buffer.remove(0, m_pos);
+        m_discarded += m_pos;
+        m_pos = 0;
+        m_data = m_buffer;
+    }
+
+    void skipByteOrderMark() {
+        if (available(3) && m_data.sliced(m_pos, 3) == QByteArrayView("\xEF\xBB\xBF")) {
+            m_pos += 3;
+        }
+    }
+
+private:
+    QIODevice* m_device;
+    QByteArray m_buffer;  ///< Bytes read from the device that have not been discarded yet
+    qsizetype m_discarded = 0;
+};
+
+/**
+ * @class JsonObjectReader
+ * @brief Pull parser for a flat JSON object of settings that reads one member at a time without building a document.
+ *
+ * String values are returned as-is, numbers and booleans as their literal text, null as an empty string.
+ * Nested objects and arrays are skipped and yield an empty string, like QJsonValue::toString() does.
+ */
+class JsonObjectReader : public ByteInput {
+public:
+    explicit JsonObjectReader(QByteArrayView data, QIODevice* device = nullptr)
+        : ByteInput(data, device) {
+        skipByteOrderMark();
+    }
+
+    /**
+     * @brief Reads the next member of the object.
+     * @return True if a member was read, false at the end of the object or on error.
+     */
+    bool readNext(QString& key, QString& value) {
+        if (m_finished || hasError()) {
+            return false;
+        }
+
+        discardConsumed();
+        skipWhitespace();
+        if (!m_started) {
+            if (!consume('{')) {
+                return fail("expected '{'");
+            }
+            m_started = true;
+            skipWhitespace();
+            if (consume('}')) {
+                return finish();
+            }
+        } else if (consume(',')) {
+            skipWhitespace();
+        } else if (consume('}')) {
+            return finish();
+        } else {
+            return fail("expected ',' or '}'");
+        }
+
+        if (!readString(key)) {
+            return false;
+        }
+        skipWhitespace();
+        if (!consume(':')) {
+            return fail("expected ':'");
+        }
+        skipWhitespace();
+        return readValue(value);
+    }
+
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+private:
+    bool m_started = false;
+    bool m_finished = false;
+    QString m_error;
+
+    bool fail(const char* message) {
+        m_error = QStringLiteral("%1 at offset %2").arg(QLatin1StringView(message)).arg(position());
+        return false;
+    }
+
+    bool finish() {
+        m_finished = true;
+        skipWhitespace();
+        if (available()) {
+            return fail("unexpected data after object");
+        }
+        return false;
+    }
+
+    bool consume(char c) {
+        if (available() && m_data[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                break;
+            }
+            ++m_pos;
+        }
+    }
+
+    bool readString(QString& out) {
+        if (!consume('"')) {
+            return fail("expected string");
+        }
+
+        // Fast path: no escape sequences, decode the slice directly
+        const qsizetype start = m_pos;
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c == '"') {
+                out = QString::fromUtf8(m_data.sliced(start, m_pos - start));
+                ++m_pos;
+                return true;
+            }
+            if (c == '\\') {
+                break;
+            }
+            if (static_cast<uchar>(c) < 0x20) {
+                return fail("control character in string");
+            }
+            ++m_pos;
+        }
+
+        out = QString::fromUtf8(m_data.sliced(start, m_pos - start));
+        qsizetype segment = m_pos;
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c == '"') {
+                out += QString::fromUtf8(m_data.sliced(segment, m_pos - segment));
+                ++m_pos;
+                return true;
+            }
+            if (static_cast<uchar>(c) < 0x20) {
+                return fail("control character in string");
+            }
+            if (c != '\\') {
+                ++m_pos;
+                continue;
+            }
+
+            out += QString::fromUtf8(m_data.sliced(segment, m_pos - segment));
+            ++m_pos;
+            if (!available()) {
+                break;
+            }
+            switch (m_data[m_pos++]) {
+            case '"':  out += u'"'; break;
+            case '\\': out += u'\\'; break;
+            case '/':  out += u'/'; break;
+            case 'b':  out += u'\b'; break;
+            case 'f':  out += u'\f'; break;
+            case 'n':  out += u'\n'; break;
+            case 'r':  out += u'\r'; break;
+            case 't':  out += u'\t'; break;
+            case 'u': {
+                if (!available(4)) {
+                    return fail("truncated unicode escape");
+                }
+                char16_t unit = 0;
+                for (int i = 0; i < 4; ++i) {
+                    const int digit = hexValue(m_data[m_pos++]);
+                    if (digit < 0) {
+                        return fail("invalid unicode escape");
+                    }
+                    unit = static_cast<char16_t>((unit << 4) | digit);
+                }
+                out += QChar(unit);
+                break;
+            }
+            default:
+                return fail("invalid escape sequence");
+            }
+            segment = m_pos;
+        }
+        return fail("unterminated string");
+    }
+
+    bool readValue(QString& out) {
+        if (!available()) {
+            return fail("expected value");
+        }
+
+        const char c = m_data[m_pos];
+        if (c == '"') {
+            return readString(out);
+        }
+        if (c == '{' || c == '[') {
+            out.clear();
+            return skipComposite();
+        }
+
+        const qsizetype start = m_pos;
+        while (available()) {
+            const char d = m_data[m_pos];
+            if (d == ',' || d == '}' || d == ']' || d == ' ' || d == '\t' || d == '\n' || d == '\r') {
+                break;
+            }
+            ++m_pos;
+        }
+
+        const QByteArrayView literal = m_data.sliced(start, m_pos - start);
+        if (literal == "null") {
+            out.clear();
+        } else if (literal == "true" || literal == "false" || (!literal.isEmpty() && (literal[0] == '-' || (literal[0] >= '0' && literal[0] <= '9')))) {
+            out = QString::fromLatin1(literal);
+        } else {
+            return fail("invalid value");
+        }
+        return true;
+    }
+
+    bool skipComposite() {
+        int depth = 0;
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c == '"') {
+                QString ignored;
+                if (!readString(ignored)) {
+                    return false;
+                }
+                continue;
+            }
+            ++m_pos;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return true;
+            }
+        }
+        return fail("unterminated object or array");
+    }
+};
+
+/**
+ * @brief Quotes a CSV or plain text field when it contains the separator, a quote or a line break.
+ * @param text The field text.
+ * @param separator The field separator of the format.
+ * @return The field, quoted with embedded quotes doubled if needed (RFC 4180).
+ */
+QString quoteField(const QString& text, QChar separator) {
+    bool needsQuoting = false;
+    for (const QChar c : text) {
+        if (c == separator || c == u'"' || c == u'\n' || c == u'\r') {
+            needsQuoting = true;
+            break;
+        }
+    }
+    if (!needsQuoting) {
+        return text;
+    }
+
+    QString quoted;
+    quoted.reserve(text.size() + 2);
+    quoted += u'"';
+    for (const QChar c : text) {
+        if (c == u'"') {
+            quoted += u'"';
+        }
+        quoted += c;
+    }
+    quoted += u'"';
+    return quoted;
+}
+
+/**
+ * @class DelimitedReader
+ * @brief Byte-level parser for CSV (RFC 4180) and key=value records over an in-memory or mapped buffer or a device.
+ *
+ * Unquoted fields are decoded directly from the buffer; quoted fields are only copied when they contain
+ * escaped quotes. An unquoted value is the last field and runs to the end of the line, so it may contain
+ * the separator. Empty lines and lines without a separator are skipped. Quoted fields follow RFC 4180 strictly.
+ */
+class DelimitedReader : public ByteInput {
+public:
+    enum Mode {
+        Csv,      ///< key,value
+        KeyValue  ///< key=value
+    };
+
+    DelimitedReader(QByteArrayView data, Mode mode, QIODevice* device = nullptr)
+        : ByteInput(data, device)
+        , m_separator(mode == Csv ? ',' : '=') {
+        skipByteOrderMark();
+    }
+
+    /**
+     * @brief Reads the next record.
+     * @return True if a record was read, false at the end of the data or on error.
+     */
+    bool readNext(QString& key, QString& value) {
+        for (;;) {
+            discardConsumed();
+            while (available() && (m_data[m_pos] == '\n' || m_data[m_pos] == '\r')) {
+                if (m_data[m_pos++] == '\n') {
+                    ++m_line;
+                }
+            }
+            if (!available() || hasError()) {
+                return false;
+            }
+
+            if (!readField(key, true)) {
+                return false;
+            }
+            if (consume(m_separator)) {
+                break;
+            }
+            if (available() && m_data[m_pos] != '\n' && m_data[m_pos] != '\r') {
+                return fail("missing separator");  // Data after a quoted key
+            }
+            // A line without a separator holds no record
+        }
+
+        if (!readField(value, false)) {
+            return false;
+        }
+        if (available() && !consumeLineEnd()) {
+            return fail("unexpected data after value");
+        }
+        return true;
+    }
+
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+private:
+    char m_separator;
+    qsizetype m_line = 1;
+    QByteArray m_unescaped;  ///< Scratch buffer for quoted fields with escaped quotes
+    QString m_error;
+
+    bool fail(const char* message) {
+        m_error = QStringLiteral("%1 on line %2").arg(QLatin1StringView(message)).arg(m_line);
+        return false;
+    }
+
+    bool consume(char c) {
+        if (available() && m_data[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeLineEnd() {
+        consume('\r');
+        if (!available() || consume('\n')) {
+            ++m_line;
+            return true;
+        }
+        return false;
+    }
+
+    bool readField(QString& out, bool isKey) {
+        if (consume('"')) {
+            return readQuotedField(out);
+        }
+
+        // Keys stop at the separator, values only at the end of the line
+        const qsizetype start = m_pos;
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c == '\n' || c == '\r' || (isKey && c == m_separator)) {
+                break;
+            }
+            ++m_pos;
+        }
+        out = QString::fromUtf8(m_data.sliced(start, m_pos - start));
+        return true;
+    }
+
+    bool readQuotedField(QString& out) {
+        const qsizetype start = m_pos;
+        bool escaped = false;
+        while (available()) {
+            const char c = m_data[m_pos];
+            if (c == '"') {
+                if (available(2) && m_data[m_pos + 1] == '"') {
+                    escaped = true;
+                    m_pos += 2;
+                    continue;
+                }
+                break;
+            }
+            if (c == '\n') {
+                ++m_line;
+            }
+            ++m_pos;
+        }
+        if (!available()) {
+            return fail("unterminated quoted field");
+        }
+
+        const QByteArrayView field = m_data.sliced(start, m_pos - start);
+        ++m_pos;  // closing quote
+
+        if (!escaped) {
+            out = QString::fromUtf8(field);
+            return true;
+        }
+
+        m_unescaped.truncate(0);
+        for (qsizetype i = 0; i < field.size(); ++i) {
+            m_unescaped += field[i];
+            if (field[i] == '"') {
+                ++i;
+            }
+        }
+        out = QString::fromUtf8(m_unescaped);
+        return true;
+    }
+};
+
+/**
+ * @class SettingsWriter
+ * @brief Streams key/value pairs to a file in one export format.
+ *
+ * File names ending in ".gz" are gzip-compressed while they are written. Formats that need a real file
+ * (INI is written by QSettings, the snapshot seeks back to its header) are staged uncompressed in a
+ * temporary file next to the target and compressed into it chunk by chunk on close().
+ */
+class SettingsWriter {
+public:
+    explicit SettingsWriter(const QString& fileName)
+        : m_file(fileName)
+        , m_compressed(fileName.endsWith(QStringLiteral(".gz"), Qt::CaseInsensitive)) {}
+    virtual ~SettingsWriter() = default;
+
+    /**
+     * @brief Opens the file and writes the format header.
+     */
+    bool open() {
+        if (!m_file.open(QIODevice::WriteOnly)) {
+            qWarning() << MTSettings::tr("Failed to open file for writing:") << m_file.fileName();
+            return false;
+        }
+        m_truncated = true;
+
+        if (m_compressed) {
+            m_gzip = std::make_unique<MTGzipDevice>(&m_file);
+            if (!m_gzip->open(QIODevice::WriteOnly)) {
+                qWarning() << MTSettings::tr("Failed to start compression:") << m_gzip->errorString();
+                return false;
+            }
+            if (needsPlainFile()) {
+                m_staging = std::make_unique<QTemporaryFile>(m_file.fileName() + QStringLiteral(".XXXXXX"));
+                if (!m_staging->open()) {
+                    qWarning() << MTSettings::tr("Failed to create temporary file for:") << m_file.fileName();
+                    return false;
+                }
+            }
+        }
+        return begin();
+    }
+
+    /**
+     * @brief Writes one key/value pair.
+     */
+    virtual void write(const QString& key, const QVariant& value) = 0;
+
+    /**
+     * @brief Returns true if write() must be called on the thread that opened the writer.
+     */
+    virtual bool needsOwnerThread() const { return false; }
+
+    /**
+     * @brief Writes the format footer and closes the file.
+     * @return True if everything was written without errors.
+     */
+    bool close() {
+        bool finished = end();
+        if (m_staging) {
+            finished = compressStaging() && finished;
+            m_staging.reset();
+        }
+        if (m_gzip) {
+            finished = m_gzip->finish() && finished;
+            m_gzip.reset();
+        }
+        m_file.close();
+        return finished && m_file.error() == QFileDevice::NoError;
+    }
+
+    /**
+     * @brief Discards the partially written file. Also removes a file that was already closed; a file that
+     *        could not be opened is left alone.
+     */
+    virtual void abort() {
+        m_staging.reset();
+        m_gzip.reset();
+        if (m_truncated) {
+            m_file.remove();
+        }
+    }
+
+protected:
+    virtual bool begin() { return true; }
+    virtual bool end() { return true; }
+
+    /**
+     * @brief Returns true if the format must be written to a seekable file rather than a stream.
+     */
+    virtual bool needsPlainFile() const { return false; }
+
+    /**
+     * @brief Returns the stream that formatted data is written to.
+     */
+    QIODevice& device() {
+        return m_gzip ? static_cast<QIODevice&>(*m_gzip) : m_file;
+    }
+
+    /**
+     * @brief Returns the uncompressed file for formats that need one.
+     */
+    QFile& plainFile() {
+        return m_staging ? static_cast<QFile&>(*m_staging) : m_file;
+    }
+
+private:
+    QFile m_file;
+    bool m_compressed;
+    std::unique_ptr<MTGzipDevice> m_gzip;
+    std::unique_ptr<QTemporaryFile> m_staging;
+    bool m_truncated = false;  ///< The file was opened, and so truncated, by this writer
+
+    bool compressStaging() {
+        // Reopen by name: QSettings replaces the file instead of writing through our handle
+        m_staging->close();
+        QFile staged(m_staging->fileName());
+        if (!staged.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        while (!staged.atEnd()) {
+            const QByteArray chunk = staged.read(CopyChunkSize);
+            if (chunk.isEmpty() || m_gzip->write(chunk) != chunk.size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+class JsonSettingsWriter : public SettingsWriter {
+public:
+    using SettingsWriter::SettingsWriter;
+
+    void write(const QString& key, const QVariant& value) override {
+        // Each member is written as soon as it is visited, so memory use does not grow with the store
+        m_member.truncate(0);
+        m_member += m_first ? "\n    " : ",\n    ";
+        appendJsonString(m_member, key);
+        m_member += ": ";
+        appendJsonString(m_member, value.toString());
+        device().write(m_member);
+        m_first = false;
+    }
+
+protected:
+    bool begin() override { return device().write("{") == 1; }
+    bool end() override { return device().write("\n}\n") == 3; }
+
+private:
+    QByteArray m_member;
+    bool m_first = true;
+};
+
+class IniSettingsWriter : public SettingsWriter {
+public:
+    using SettingsWriter::SettingsWriter;
+
+    void write(const QString& key, const QVariant& value) override {
+        m_settings->setValue(key, value);
+    }
+
+    void abort() override {
+        m_settings.reset();
+        SettingsWriter::abort();
+    }
+
+    // QSettings is a QObject living on the thread that created it
+    bool needsOwnerThread() const override { return true; }
+
+protected:
+    bool needsPlainFile() const override { return true; }
+
+    bool begin() override {
+        // The file is only truncated here; QSettings writes it on sync()
+        plainFile().close();
+        m_settings = std::make_unique<QSettings>(plainFile().fileName(), QSettings::IniFormat);
+        return true;
+    }
+
+    bool end() override {
+        m_settings->sync();
+        const bool synced = m_settings->status() == QSettings::NoError;
+        m_settings.reset();
+        return synced;
+    }
+
+private:
+    std::unique_ptr<QSettings> m_settings;
+};
+
+class XmlSettingsWriter : public SettingsWriter {
+public:
+    explicit XmlSettingsWriter(const QString& fileName)
+        : SettingsWriter(fileName) {
+        m_xml.setAutoFormatting(true);
+        m_xml.setAutoFormattingIndent(4);
+    }
+
+    void write(const QString& key, const QVariant& value) override {
+        m_xml.writeEmptyElement(QStringLiteral("Setting"));
+        m_xml.writeAttribute(QStringLiteral("key"), key);
+        m_xml.writeAttribute(QStringLiteral("value"), value.toString());
+    }
+
+protected:
+    bool begin() override {
+        m_xml.setDevice(&device());
+        m_xml.writeStartDocument();
+        m_xml.writeStartElement(QStringLiteral("Settings"));
+        return !m_xml.hasError();
+    }
+
+    bool end() override {
+        m_xml.writeEndElement();
+        m_xml.writeEndDocument();
+        return !m_xml.hasError();
+    }
+
+private:
+    QXmlStreamWriter m_xml;
+};
+
+class DelimitedSettingsWriter : public SettingsWriter {
+public:
+    DelimitedSettingsWriter(const QString& fileName, QChar separator)
+        : SettingsWriter(fileName)
+        , m_separator(separator) {}
+
+    void write(const QString& key, const QVariant& value) override {
+        m_out << quoteField(key, m_separator) << m_separator << quoteField(value.toString(), m_separator) << "\n";
+    }
+
+protected:
+    bool begin() override {
+        m_out.setDevice(&device());
+        return true;
+    }
+
+    bool end() override {
+        m_out.flush();
+        return m_out.status() == QTextStream::Ok;
+    }
+
+private:
+    QTextStream m_out;
+    QChar m_separator;
+};
+
+class SnapshotSettingsWriter : public SettingsWriter {
+public:
+    using SettingsWriter::SettingsWriter;
+
+    void write(const QString& key, const QVariant& value) override {
+        m_failed = !m_writer->add(key, value) || m_failed;
+    }
+
+protected:
+    bool needsPlainFile() const override { return true; }
+
+    bool begin() override {
+        m_writer = std::make_unique<MTSettingsSnapshot::Writer>(plainFile());
+        return m_writer->begin();
+    }
+
+    bool end() override {
+        const bool finished = !m_failed && m_writer->finish();
+        plainFile().flush();
+        return finished;
+    }
+
+private:
+    std::unique_ptr<MTSettingsSnapshot::Writer> m_writer;
+    bool m_failed = false;
+};
+
+/**
+ * @brief Returns true if a value read from a file matches the stored one.
+ *
+ * Text formats read every value back as a string, so values of different types are compared as text.
+ */
+bool sameValue(const QVariant& stored, const QVariant& loaded) {
+    if (stored.isValid() != loaded.isValid()) {
+        return false;
+    }
+    if (stored == loaded) {
+        return true;
+    }
+    return stored.metaType() != loaded.metaType() && stored.canConvert<QString>() && loaded.canConvert<QString>()
+           && stored.toString() == loaded.toString();
+}
+
+/**
+ * @brief Creates the writer for an export format.
+ * @return The writer, or nullptr if the format is unknown.
+ */
+std::unique_ptr<SettingsWriter> createSettingsWriter(MTSettings::ExportFormat format, const QString& fileName) {
+    switch (format) {
+    case MTSettings::JsonFormat:
+        return std::make_unique<JsonSettingsWriter>(fileName);
+    case MTSettings::IniFormat:
+        return std::make_unique<IniSettingsWriter>(fileName);
+    case MTSettings::XmlFormat:
+        return std::make_unique<XmlSettingsWriter>(fileName);
+    case MTSettings::CsvFormat:
+        return std::make_unique<DelimitedSettingsWriter>(fileName, u',');
+    case MTSettings::PlainTextFormat:
+        return std::make_unique<DelimitedSettingsWriter>(fileName, u'=');
+    case MTSettings::BinarySnapshotFormat:
+        return std::make_unique<SnapshotSettingsWriter>(fileName);
+    }
+    qWarning() << MTSettings::tr("Unknown export format:") << int(format);
+    return nullptr;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an MTSettings object using the provided organization and application names.
+ * @param organization The organization name.
+ * @param application The application name.
+ */
+MTSettings::MTSettings(const QString& organization, const QString& application)
+    : QSettings(organization, application) {}
+
+/**
+ * @brief Constructs an MTSettings object stored in the given file.
+ * @param fileName The name of the settings file.
+ * @param format The storage format, e.g. QSettings::IniFormat.
+ */
+MTSettings::MTSettings(const QString& fileName, QSettings::Format format)
+    : QSettings(fileName, format) {}
+
+/**
+ * @brief Destroys the object and releases all cache snapshots.
+ */
+MTSettings::~MTSettings() {
+    delete m_cache.exchange(nullptr);
+}
+
+/**
+ * @brief Exports settings to a file in the specified format.
+ * @param format The export format (e.g., JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
+ * @param fileName The name of the file to export to.
+ * @param keysToExport The list of keys to export. If empty, exports all keys.
+ * @param selection How the entries of keysToExport are interpreted.
+ * @return True if the export was successful, false otherwise.
+ */
+bool MTSettings::exportSettings(ExportFormat format, const QString& fileName, const QStringList& keysToExport,
+                                KeySelection selection) {
+    const QStringList keys = keysFor(keysToExport, selection);
+    return writeEntries(format, fileName, keys, [this](const QString& key) {
+        return value(key);
+    });
+}
+
+/**
+ * @brief Exports settings to a file on a worker thread.
+ *
+ * The keys and their values are read on the calling thread; formatting and writing happen in the thread pool.
+ * The returned future reports progress from 0 to 1000 (per mille of the keys written) and can be cancelled,
+ * in which case the file is removed. Must be called on the thread that owns this object.
+ * @param format The export format.
+ * @param fileName The name of the file to export to.
+ * @param keysToExport The list of keys to export. If empty, exports all keys.
+ * @param selection How the entries of keysToExport are interpreted.
+ * @return A future holding true if the export was successful.
+ */
+QFuture<bool> MTSettings::exportSettingsAsync(ExportFormat format, const QString& fileName, const QStringList& keysToExport,
+                                              KeySelection selection) {
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    const QStringList keys = keysFor(keysToExport, selection);
+    QHash<QString, QVariant> values;
+    values.reserve(keys.size());
+    for (const QString& key : keys) {
+        values.insert(key, value(key));
+    }
+
+    return QtConcurrent::run([format, fileName, keys, values](QPromise<bool>& promise) {
+        promise.setProgressRange(0, ProgressRange);
+        const bool written = writeEntries(format, fileName, keys, [&values](const QString& key) {
+            return values.value(key);
+        }, [&promise](qint64 done, qint64 total) {
+            promise.setProgressValue(progressPerMille(done, total));
+            return !promise.isCanceled();
+        });
+        promise.addResult(written);
+    });
+}
+
+/**
+ * @brief Exports the same keys to several files in a single pass over the store.
+ *
+ * Every value is read once and passed to the writers of all targets. With parallelWriters, values are read
+ * in batches on the calling thread and each batch is written by all writers concurrently in the thread pool
+ * while the next batch is read.
+ * @param targets The formats and files to export to.
+ * @param keysToExport The list of keys to export. If empty, exports all keys.
+ * @param selection How the entries of keysToExport are interpreted.
+ * @param parallelWriters True to run the writers on worker threads. INI writers, which use QSettings, stay on
+ *        the calling thread.
+ * @return True if all files were written successfully, false otherwise.
+ */
+bool MTSettings::exportSettings(const QList<ExportTarget>& targets, const QStringList& keysToExport,
+                                KeySelection selection, bool parallelWriters) {
+    std::vector<std::unique_ptr<SettingsWriter>> writers;
+    writers.reserve(targets.size());
+    for (const ExportTarget& target : targets) {
+        std::unique_ptr<SettingsWriter> writer = createSettingsWriter(target.format, target.fileName);
+        if (!writer || !writer->open()) {
+            // The failed writer may already have truncated its file or created a staging file
+            if (writer) {
+                writer->abort();
+            }
+            for (const auto& opened : writers) {
+                opened->abort();
+            }
+            return false;
+        }
+        writers.push_back(std::move(writer));
+    }
+
+    const QStringList keys = keysFor(keysToExport, selection);
+
+    if (!parallelWriters || writers.size() < 2) {
+        for (const QString& key : keys) {
+            const QVariant current = value(key);
+            for (const auto& writer : writers) {
+                writer->write(key, current);
+            }
+        }
+    } else {
+        // Writers backed by a QSettings object (INI) stay on this thread and write while the pool works
+        QList<SettingsWriter*> pooled;
+        QList<SettingsWriter*> local;
+        for (const auto& writer : writers) {
+            (writer->needsOwnerThread() ? local : pooled).append(writer.get());
+        }
+
+        QFuture<void> writing;
+        for (qsizetype start = 0; start < keys.size(); start += FanOutBatchSize) {
+            auto batch = std::make_shared<SettingsEntries>();
+            const qsizetype end = std::min(start + FanOutBatchSize, keys.size());
+            batch->reserve(end - start);
+            for (qsizetype i = start; i < end; ++i) {
+                batch->append(qMakePair(keys[i], value(keys[i])));
+            }
+
+            writing.waitForFinished();
+            writing = QtConcurrent::map(pooled, [batch](SettingsWriter* writer) {
+                for (const auto& entry : *batch) {
+                    writer->write(entry.first, entry.second);
+                }
+            });
+            for (SettingsWriter* writer : std::as_const(local)) {
+                for (const auto& entry : std::as_const(*batch)) {
+                    writer->write(entry.first, entry.second);
+                }
+            }
+        }
+        writing.waitForFinished();
+    }
+
+    bool written = true;
+    for (const auto& writer : writers) {
+        written = writer->close() && written;
+    }
+    if (!written) {
+        // All targets or none: files that were closed successfully are removed as well
+        for (const auto& writer : writers) {
+            writer->abort();
+        }
+        qWarning() << tr("Failed to write settings to one or more export targets.");
+    }
+    return written;
+}
+
+/**
+ * @brief Resolves group prefixes or glob patterns to the matching keys using the key index.
+ *
+ * The index is built from allKeys() on first use and then kept up to date by setValue(), remove() and clear()
+ * of this class. Keys removed through a QSettings pointer or reference, or by another process, are filtered out
+ * of the result; keys added that way are only found after rebuildKeyIndex().
+ * @param patterns The group prefixes or glob patterns.
+ * @param selection How the patterns are interpreted; ExactKeys returns the keys that exist.
+ * @return The matching keys without duplicates.
+ */
+QStringList MTSettings::matchingKeys(const QStringList& patterns, KeySelection selection) {
+    if (!m_keyIndexBuilt) {
+        rebuildKeyIndex();
+    }
+
+    QStringList keys;
+    for (const QString& pattern : patterns) {
+        const QString absolute = absoluteKey(pattern);
+        if (selection == GroupPrefixes) {
+            m_keyIndex.collectGroup(absolute, keys);
+        } else if (selection == GlobPatterns) {
+            m_keyIndex.collectGlob(absolute, keys);
+        } else if (m_keyIndex.contains(absolute)) {
+            keys.append(absolute);
+        }
+    }
+
+    // Keys are absolute in the index; make them relative to the current group again
+    const QString prefix = group();
+    if (!prefix.isEmpty()) {
+        for (QString& key : keys) {
+            key.remove(0, prefix.size() + 1);
+        }
+    }
+
+    // Drop keys removed behind the index's back, e.g. through a QSettings pointer
+    keys.removeIf([this](const QString& key) {
+        return !contains(key);
+    });
+
+    if (patterns.size() > 1 || selection == GlobPatterns) {
+        keys.removeDuplicates();
+    }
+    return keys;
+}
+
+/**
+ * @brief Rebuilds the key index from allKeys().
+ */
+void MTSettings::rebuildKeyIndex() {
+    m_keyIndex.clear();
+
+    // Index the whole store, not only the current group
+    const QStringList openGroups = leaveGroups();
+    const QStringList keys = allKeys();
+    restoreGroups(openGroups);
+
+    for (const QString& key : keys) {
+        m_keyIndex.insert(key);
+    }
+    m_keyIndexBuilt = true;
+}
+
+/**
+ * @brief Leaves all open groups and returns each beginGroup() argument, outermost first, for restoreGroups().
+ */
+QStringList MTSettings::leaveGroups() {
+    QStringList openGroups;
+    while (!group().isEmpty()) {
+        const QString before = group();
+        endGroup();
+        const QString after = group();
+        openGroups.prepend(after.isEmpty() ? before : before.mid(after.size() + 1));
+    }
+    return openGroups;
+}
+
+/**
+ * @brief Reopens the groups left by leaveGroups().
+ */
+void MTSettings::restoreGroups(const QStringList& openGroups) {
+    for (const QString& openGroup : openGroups) {
+        beginGroup(openGroup);
+    }
+}
+
+/**
+ * @brief Sets the value of a key and keeps the key index and the read cache up to date. Hides QSettings::setValue().
+ */
+void MTSettings::setValue(const QString& key, const QVariant& value) {
+    writeValue(key, value);
+    if (m_cache.load()) {
+        publishCachedValue(absoluteKey(key), value);
+    }
+}
+
+/**
+ * @brief Removes a key and its subkeys and keeps the key index and the read cache up to date. Hides QSettings::remove().
+ */
+void MTSettings::remove(const QString& key) {
+    removeValue(key);
+    if (m_cache.load()) {
+        // An empty key removes the whole current group
+        invalidateCache(key.isEmpty() ? group() : absoluteKey(key));
+    }
+}
+
+/**
+ * @brief Removes all keys of the store, not only those of the current group, like QSettings::clear(),
+ *        and resets the key index and the read cache. Hides QSettings::clear().
+ */
+void MTSettings::clear() {
+    QSettings::clear();
+    m_keyIndex.clear();
+    if (m_cache.load()) {
+        invalidateCache(QString());
+    }
+}
+
+/**
+ * @brief Writes a value to the store and the key index, leaving the read cache alone.
+ */
+void MTSettings::writeValue(const QString& key, const QVariant& value) {
+    QSettings::setValue(key, value);
+    if (m_keyIndexBuilt) {
+        m_keyIndex.insert(absoluteKey(key));
+    }
+}
+
+/**
+ * @brief Removes a key from the store and the key index, leaving the read cache alone.
+ */
+void MTSettings::removeValue(const QString& key) {
+    QSettings::remove(key);
+    if (m_keyIndexBuilt) {
+        m_keyIndex.remove(absoluteKey(key));
+    }
+}
+
+/**
+ * @brief Returns the keys to export for the given key list and selection mode.
+ */
+QStringList MTSettings::keysFor(const QStringList& keysToExport, KeySelection selection) {
+    if (keysToExport.isEmpty()) {
+        return allKeys();
+    }
+    return selection == ExactKeys ? keysToExport : matchingKeys(keysToExport, selection);
+}
+
+/**
+ * @brief Returns the key prefixed with the current group, as stored in the key index and the read cache.
+ */
+QString MTSettings::absoluteKey(const QString& key) const {
+    const QString prefix = group();
+    return prefix.isEmpty() ? key : prefix + u'/' + key;
+}
+
+/**
+ * @brief Imports settings from a file in the specified format.
+ *
+ * The whole file is parsed and staged before anything is written, so a malformed file leaves the store untouched.
+ * All values are then applied in one pass followed by a single sync(). If a transaction is already active,
+ * the imported values are added to it and written by the caller's commitTransaction().
+ * @param format The import format (e.g., JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
+ * @param fileName The name of the file to import from.
+ * @return True if the import was successful, false otherwise.
+ */
+bool MTSettings::importSettings(ExportFormat format, const QString& fileName) {
+    SettingsEntries entries;
+    if (!readEntries(format, fileName, entries)) {
+        return false;
+    }
+    return applyEntries(std::move(entries));
+}
+
+/**
+ * @brief Imports settings from a file, parsing it on a worker thread.
+ *
+ * Only the parsing runs in the thread pool. The parsed values are written back in one batch on the thread
+ * that owns this object, exactly like importSettings() does. The returned future reports parsing progress in per mille
+ * and can be cancelled; a cancelled import leaves the store untouched. Must be called on the thread that owns this
+ * object, whose event loop delivers the parsed values.
+ * @param format The import format.
+ * @param fileName The name of the file to import from.
+ * @return A future holding true if the import was successful.
+ */
+QFuture<bool> MTSettings::importSettingsAsync(ExportFormat format, const QString& fileName) {
+    // The watcher below is a child of this object and the values are applied by its finished() handler
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    auto promise = std::make_shared<QPromise<bool>>();
+    promise->setProgressRange(0, ProgressRange);
+    promise->start();
+
+    QFuture<std::optional<SettingsEntries>> parsing = QtConcurrent::run([format, fileName, promise]() {
+        SettingsEntries entries;
+        const bool parsed = readEntries(format, fileName, entries, [&promise](qint64 done, qint64 total) {
+            promise->setProgressValue(progressPerMille(done, total));
+            return !promise->isCanceled();
+        });
+        return parsed ? std::optional<SettingsEntries>(std::move(entries)) : std::nullopt;
+    });
+
+    // The watcher is owned by this object, so the apply step never runs after it has been destroyed
+    auto* watcher = new QFutureWatcher<std::optional<SettingsEntries>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, promise]() {
+        watcher->deleteLater();
+        const std::optional<SettingsEntries> entries = watcher->result();
+        const bool imported = entries && !promise->isCanceled() && applyEntries(*entries);
+        promise->addResult(imported);
+        promise->finish();
+    });
+    watcher->setFuture(parsing);
+
+    return promise->future();
+}
+
+/**
+ * @brief Memory-maps a binary snapshot for on-demand lookups with snapshotValue().
+ *
+ * Nothing is copied into the store: only the header is read on open and each value is decoded the first
+ * time it is requested. Gzip-compressed snapshots cannot be mapped and must be imported instead.
+ * @param fileName The name of the snapshot file.
+ * @return True if the snapshot was opened, false otherwise.
+ */
+bool MTSettings::openSnapshot(const QString& fileName) {
+    auto snapshot = std::make_unique<MTSettingsSnapshot>();
+    if (!snapshot->open(fileName)) {
+        return false;
+    }
+    m_snapshot = std::move(snapshot);
+    return true;
+}
+
+/**
+ * @brief Unmaps the snapshot opened with openSnapshot().
+ */
+void MTSettings::closeSnapshot() {
+    m_snapshot.reset();
+}
+
+/**
+ * @brief Returns true if a snapshot is open for on-demand lookups.
+ */
+bool MTSettings::isSnapshotOpen() const {
+    return m_snapshot != nullptr;
+}
+
+/**
+ * @brief Returns a value from the open snapshot, decoding it on first access.
+ * @param key The settings key, relative to the current group.
+ * @param defaultValue The value returned when no snapshot is open or the key is missing or holds an invalid value.
+ */
+QVariant MTSettings::snapshotValue(const QString& key, const QVariant& defaultValue) const {
+    if (!m_snapshot) {
+        return defaultValue;
+    }
+    const QVariant value = m_snapshot->value(absoluteKey(key));
+    return value.isValid() ? value : defaultValue;
+}
+
+/**
+ * @brief Writes parsed values to the store in one batch, or adds them to the active transaction.
+ * @param entries The values to write.
+ * @return True if the values were written or staged successfully, false otherwise.
+ */
+bool MTSettings::applyEntries(SettingsEntries entries) {
+    if (m_transactionActive) {
+        m_stagedValues += entries;
+        return true;
+    }
+
+    beginTransaction();
+    m_stagedValues = std::move(entries);
+    return commitTransaction();
+}
+
+/**
+ * @brief Starts a transaction. Values passed to stageValue() are kept in memory until commitTransaction().
+ *
+ * Transactions do not nest: the values staged in an active transaction are kept and the call fails.
+ * @return True if the transaction was started, false if another transaction is already active.
+ */
+bool MTSettings::beginTransaction() {
+    if (m_transactionActive) {
+        qWarning() << tr("A transaction is already active.");
+        return false;
+    }
+    m_stagedValues.clear();
+    m_transactionActive = true;
+    return true;
+}
+
 /**
- * @brief Constructs an MTSettings object using the provided organization and application names.
- * @param organization The organization name.
- * @param application The application name.
+ * @brief Stages a value in the active transaction.
+ * @param key The settings key.
+ * @param value The value to store on commit. An invalid QVariant removes the key on commit.
+ * @return True if the value was staged, false if no transaction is active.
  */
-MTSettings::MTSettings(const QString& organization, const QString& application)
-    : QSettings(organization, application) {}
+bool MTSettings::stageValue(const QString& key, const QVariant& value) {
+    if (!m_transactionActive) {
+        qWarning() << tr("No active transaction for key:") << key;
+        return false;
+    }
+    m_stagedValues.append(qMakePair(key, value));
+    return true;
+}
 
 /**
- * @brief Exports settings to a file in the specified format.
- * @param format The export format (e.g., JSON, INI, XML, CSV, or Plain Text).
- * @param fileName The name of the file to export to.
- * @param keysToExport The list of keys to export. If empty, exports all keys.
- * @return True if the export was successful, false otherwise.
+ * @brief Stages the removal of a key in the active transaction.
+ * @param key The settings key.
+ * @return True if the removal was staged, false if no transaction is active.
  */
-bool MTSettings::exportSettings(ExportFormat format, const QString& fileName, const QStringList& keysToExport) {
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << tr("Failed to open file for writing:") << fileName;
+bool MTSettings::stageRemove(const QString& key) {
+    return stageValue(key, QVariant());
+}
+
+/**
+ * @brief Applies all staged values in one pass and synchronizes the store once.
+ * @return True if the store was written without errors, false otherwise.
+ */
+bool MTSettings::commitTransaction() {
+    if (!m_transactionActive) {
+        qWarning() << tr("No active transaction to commit.");
         return false;
     }
 
-    QStringList keys = keysToExport.isEmpty() ? allKeys() : keysToExport;
+    const SettingsEntries staged = std::exchange(m_stagedValues, SettingsEntries());
+    m_transactionActive = false;
 
-    if (format == JsonFormat) {
-        QJsonObject json;
-        for (const QString& key : keys) {
-            json[key] = value(key).toString();
+    // The cache is rebuilt once below instead of being republished for every key
+    for (const auto& entry : staged) {
+        if (entry.second.isValid()) {
+            writeValue(entry.first, entry.second);
+        } else {
+            removeValue(entry.first);
         }
-        QJsonDocument doc(json);
-        file.write(doc.toJson(QJsonDocument::Indented));
-    } else if (format == IniFormat) {
-        QSettings iniSettings(fileName, QSettings::IniFormat);
-        for (const QString& key : keys) {
-            iniSettings.setValue(key, value(key));
+    }
+    sync();
+
+    if (m_cache.load()) {
+        refreshCache();
+    }
+
+    if (status() != QSettings::NoError) {
+        qWarning() << tr("Failed to write settings on commit.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Discards all staged values and ends the transaction without touching the store.
+ */
+void MTSettings::rollbackTransaction() {
+    m_stagedValues.clear();
+    m_transactionActive = false;
+}
+
+/**
+ * @brief Returns true if a transaction is active.
+ */
+bool MTSettings::isTransactionActive() const {
+    return m_transactionActive;
+}
+
+/**
+ * @brief Appends the changes made since the previous delta export to a journal file.
+ *
+ * A content hash of every key is kept in a state file next to the journal (<journal>.state).
+ * Only keys whose hash was added, changed or removed since the previous call are written, as one batch
+ * of JSON lines terminated by a commit record. The first call writes every key and serves as the base.
+ * @param journalFileName The name of the journal file to append to.
+ * @return True if the journal and the state file were written successfully, false otherwise.
+ */
+bool MTSettings::exportDelta(const QString& journalFileName) {
+    const QString stateFileName = journalFileName + QStringLiteral(".state");
+
+    quint64 sequence = 0;
+    QHash<QString, QByteArray> previousHashes;
+    QFile stateFile(stateFileName);
+    if (stateFile.exists()) {
+        if (!stateFile.open(QIODevice::ReadOnly)) {
+            qWarning() << tr("Failed to open file for reading:") << stateFileName;
+            return false;
         }
-    } else if (format == XmlFormat) {
-        QDomDocument doc;
-        QDomElement root = doc.createElement("Settings");
-        doc.appendChild(root);
+        QDataStream in(&stateFile);
+        in.setVersion(DeltaStreamVersion);
+        in >> sequence >> previousHashes;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << tr("Invalid delta state in file:") << stateFileName;
+            return false;
+        }
+        stateFile.close();
+    }
 
-        for (const QString& key : keys) {
-            QDomElement setting = doc.createElement("Setting");
-            setting.setAttribute("key", key);
-            setting.setAttribute("value", value(key).toString());
-            root.appendChild(setting);
-        }
-        QTextStream out(&file);
-        doc.save(out, 4);
-    } else if (format == CsvFormat) {
-        QTextStream out(&file);
-        for (const QString& key : keys) {
-            out << key << "," << value(key).toString() << "\n";
+    QByteArray batch;
+    QHash<QString, QByteArray> currentHashes;
+    const QStringList keys = allKeys();
+    currentHashes.reserve(keys.size());
+    for (const QString& key : keys) {
+        const QVariant current = value(key);
+        const QByteArray hash = deltaHash(current);
+        if (previousHashes.value(key) != hash) {
+            appendDeltaRecord(batch, QStringLiteral("set"), key, current);
         }
-    } else if (format == PlainTextFormat) {
-        QTextStream out(&file);
-        for (const QString& key : keys) {
-            out << key << "=" << value(key).toString() << "\n";
+        previousHashes.remove(key);
+        currentHashes.insert(key, hash);
+    }
+    for (auto it = previousHashes.constBegin(); it != previousHashes.constEnd(); ++it) {
+        appendDeltaRecord(batch, QStringLiteral("remove"), it.key(), QVariant());
+    }
+
+    if (!batch.isEmpty()) {
+        ++sequence;
+        QJsonObject commit;
+        commit.insert(QStringLiteral("op"), QStringLiteral("commit"));
+        commit.insert(QStringLiteral("seq"), static_cast<qint64>(sequence));
+        commit.insert(QStringLiteral("time"), QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs));
+        batch += QJsonDocument(commit).toJson(QJsonDocument::Compact);
+        batch += '\n';
+
+        QFile journal(journalFileName);
+        if (!journal.open(QIODevice::WriteOnly | QIODevice::Append) || journal.write(batch) != batch.size()) {
+            qWarning() << tr("Failed to write delta journal:") << journalFileName;
+            return false;
         }
+        journal.close();
     }
 
-    file.close();
+    // The journal is written before the state, so a failure in between only repeats this batch next time
+    QSaveFile newState(stateFileName);
+    if (!newState.open(QIODevice::WriteOnly)) {
+        qWarning() << tr("Failed to open file for writing:") << stateFileName;
+        return false;
+    }
+    QDataStream out(&newState);
+    out.setVersion(DeltaStreamVersion);
+    out << sequence << currentHashes;
+    return newState.commit();
+}
+
+/**
+ * @brief Replays a delta journal onto the store.
+ *
+ * Batches are applied in file order as a single transaction. A trailing batch without a commit record,
+ * left by an interrupted export, is ignored, including a torn last record that cannot be parsed.
+ * A malformed record followed by a commit record means the journal is corrupted; it leaves the store untouched.
+ * @param journalFileName The name of the journal file to replay.
+ * @return True if the journal was replayed successfully, false otherwise.
+ */
+bool MTSettings::importDelta(const QString& journalFileName) {
+    QFile journal(journalFileName);
+    if (!journal.open(QIODevice::ReadOnly)) {
+        qWarning() << tr("Failed to open file for reading:") << journalFileName;
+        return false;
+    }
+
+    const QByteArray data = mapFile(journal);
+    SettingsEntries committed;
+    SettingsEntries pending;
+    QByteArray invalidRecord;  // First malformed record of the current batch
+    qsizetype lineStart = 0;
+    while (lineStart < data.size()) {
+        qsizetype lineEnd = data.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            lineEnd = data.size();
+        }
+        const QByteArray line = data.sliced(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        const QJsonObject record = QJsonDocument::fromJson(line).object();
+        const QString op = record.value(QStringLiteral("op")).toString();
+        const QString key = record.value(QStringLiteral("key")).toString();
+        if (op == QStringLiteral("commit")) {
+            if (!invalidRecord.isEmpty()) {
+                qWarning() << tr("Invalid delta record in file:") << journalFileName << invalidRecord;
+                return false;
+            }
+            committed += pending;
+            pending.clear();
+        } else if (!invalidRecord.isEmpty()) {
+            // Only fatal if a commit record follows; otherwise the batch is dropped below
+            continue;
+        } else if (op == QStringLiteral("set") && !key.isEmpty()) {
+            pending.append(qMakePair(key, deltaValue(record)));
+        } else if (op == QStringLiteral("remove") && !key.isEmpty()) {
+            pending.append(qMakePair(key, QVariant()));
+        } else {
+            invalidRecord = line;
+        }
+    }
+
+    if (!invalidRecord.isEmpty()) {
+        qWarning() << tr("Ignoring torn delta record in uncommitted batch in file:") << journalFileName << invalidRecord;
+    } else if (!pending.isEmpty()) {
+        qWarning() << tr("Ignoring uncommitted delta batch in file:") << journalFileName;
+    }
+
+    journal.close();
+    return applyEntries(std::move(committed));
+}
+
+/**
+ * @brief Returns a stable content hash of a value, used to detect changes between delta exports.
+ */
+QByteArray MTSettings::deltaHash(const QVariant& value) {
+    QByteArray bytes;
+    {
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream.setVersion(DeltaStreamVersion);
+        stream << value;
+    }
+    return QCryptographicHash::hash(bytes, QCryptographicHash::Md5);
+}
+
+/**
+ * @brief Appends one journal record as a JSON line.
+ *
+ * Strings, numbers and booleans are stored as JSON values; other types are stored as base64-encoded
+ * QDataStream data so that they survive the round trip.
+ */
+void MTSettings::appendDeltaRecord(QByteArray& out, const QString& op, const QString& key, const QVariant& value) {
+    QJsonObject record;
+    record.insert(QStringLiteral("op"), op);
+    record.insert(QStringLiteral("key"), key);
+    if (value.isValid()) {
+        switch (value.typeId()) {
+        case QMetaType::QString:
+        case QMetaType::Bool:
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+        case QMetaType::Double:
+            record.insert(QStringLiteral("value"), QJsonValue::fromVariant(value));
+            break;
+        default: {
+            QByteArray bytes;
+            QDataStream stream(&bytes, QIODevice::WriteOnly);
+            stream.setVersion(DeltaStreamVersion);
+            stream << value;
+            record.insert(QStringLiteral("data"), QString::fromLatin1(bytes.toBase64()));
+        }
+        }
+    }
+    out += QJsonDocument(record).toJson(QJsonDocument::Compact);
+    out += '\n';
+}
+
+/**
+ * @brief Returns the value stored in a "set" journal record.
+ */
+QVariant MTSettings::deltaValue(const QJsonObject& record) {
+    const QJsonValue data = record.value(QStringLiteral("data"));
+    if (data.isString()) {
+        QDataStream stream(QByteArray::fromBase64(data.toString().toLatin1()));
+        stream.setVersion(DeltaStreamVersion);
+        QVariant value;
+        stream >> value;
+        return value;
+    }
+    return record.value(QStringLiteral("value")).toVariant();
+}
+
+/**
+ * @brief Keeps the store in sync with an external file that may be edited while the application runs.
+ *
+ * The file is loaded immediately and again whenever it changes on disk. Bursts of writes are coalesced:
+ * the file is re-parsed once no change has been seen for debounceMs milliseconds. Only keys whose value
+ * differs from the store are written, in one batch, and valueChanged() is emitted for each of them.
+ * Keys that disappear from the file are removed. Replacing the file (save via rename) is also detected.
+ * @param format The file format (JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
+ * @param fileName The name of the file to watch.
+ * @param debounceMs The quiet period after the last change before the file is reloaded.
+ * @return True if the file was loaded and is being watched, false otherwise.
+ */
+bool MTSettings::watchFile(ExportFormat format, const QString& fileName, int debounceMs) {
+    stopWatching();
+
+    m_watchFormat = format;
+    m_watchedFile = QFileInfo(fileName).absoluteFilePath();
+    if (!reloadWatchedFile()) {
+        m_watchedFile.clear();
+        return false;
+    }
+
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(debounceMs);
+    connect(m_reloadTimer, &QTimer::timeout, this, [this]() {
+        reloadWatchedFile();
+    });
+
+    // The directory is watched as well, because editors that save via rename replace the watched inode
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(m_watchedFile);
+    m_watcher->addPath(QFileInfo(m_watchedFile).absolutePath());
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_reloadTimer, qOverload<>(&QTimer::start));
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        if (!m_watcher->files().contains(m_watchedFile) && QFile::exists(m_watchedFile)) {
+            m_watcher->addPath(m_watchedFile);
+            m_reloadTimer->start();
+        }
+    });
     return true;
 }
 
 /**
- * @brief Imports settings from a file in the specified format.
- * @param format The import format (e.g., JSON, INI, XML, CSV, or Plain Text).
- * @param fileName The name of the file to import from.
- * @return True if the import was successful, false otherwise.
+ * @brief Stops watching the file passed to watchFile(). The store keeps its current values.
  */
-bool MTSettings::importSettings(ExportFormat format, const QString& fileName) {
+void MTSettings::stopWatching() {
+    delete m_watcher;
+    m_watcher = nullptr;
+    delete m_reloadTimer;
+    m_reloadTimer = nullptr;
+    m_watchedFile.clear();
+    m_watchedKeys.clear();
+}
+
+/**
+ * @brief Returns true if a file is being watched.
+ */
+bool MTSettings::isWatching() const {
+    return m_watcher != nullptr;
+}
+
+/**
+ * @brief Re-parses the watched file and writes only the keys that differ from the store.
+ * @return True if the file was parsed and the changes were written, false otherwise.
+ */
+bool MTSettings::reloadWatchedFile() {
+    if (m_transactionActive) {
+        // Do not mix file changes into a caller's transaction; try again after the next quiet period
+        if (m_reloadTimer) {
+            m_reloadTimer->start();
+        }
+        return false;
+    }
+
+    // A half-written file fails to parse; the write that completes it triggers another reload
+    SettingsEntries entries;
+    if (!readEntries(m_watchFormat, m_watchedFile, entries)) {
+        return false;
+    }
+
+    QHash<QString, QVariant> loaded;
+    loaded.reserve(entries.size());
+    for (auto& entry : entries) {
+        loaded.insert(entry.first, std::move(entry.second));
+    }
+
+    SettingsEntries changes;
+    for (auto it = loaded.cbegin(); it != loaded.cend(); ++it) {
+        if (!sameValue(value(it.key()), it.value())) {
+            changes.append(qMakePair(it.key(), it.value()));
+        }
+    }
+    for (const QString& key : std::as_const(m_watchedKeys)) {
+        if (!loaded.contains(key) && contains(key)) {
+            changes.append(qMakePair(key, QVariant()));
+        }
+    }
+
+    // Listeners only hear about changes that reached the store; a failed write is retried on the next reload
+    if (!changes.isEmpty() && !applyEntries(changes)) {
+        qWarning() << tr("Failed to apply changes of watched file:") << m_watchedFile;
+        return false;
+    }
+    m_watchedKeys = QSet<QString>(loaded.keyBegin(), loaded.keyEnd());
+    for (const auto& change : std::as_const(changes)) {
+        emit valueChanged(change.first, change.second);
+    }
+    return true;
+}
+
+/**
+ * @brief Rebuilds the read cache from the whole store, not only the current group, and publishes it to readers.
+ *
+ * Readers keep using the previous snapshot until they finish; it is released as soon as they have left it.
+ * The cache is also rebuilt by commitTransaction() once it has been published.
+ */
+void MTSettings::refreshCache() {
+    QMutexLocker locker(&m_cacheWriteMutex);
+
+    const QStringList openGroups = leaveGroups();
+    const QStringList keys = allKeys();
+    for (const QString& key : keys) {
+        cacheSlot(key);
+    }
+
+    auto* snapshot = new CacheSnapshot;
+    snapshot->slotByKey = m_cacheSlots;
+    snapshot->values.resize(m_cacheSlots.size());
+    for (const QString& key : keys) {
+        snapshot->values[m_cacheSlots.value(key)] = value(key);
+    }
+    restoreGroups(openGroups);
+    publishCache(snapshot);
+}
+
+/**
+ * @brief Returns a handle for repeated cached lookups of the key.
+ *
+ * Handles stay valid for the lifetime of the object, also for keys that are added to the store later.
+ * @param key The settings key, relative to the current group.
+ */
+MTSettings::KeyHandle MTSettings::cacheHandle(const QString& key) {
+    QMutexLocker locker(&m_cacheWriteMutex);
+
+    const QString absolute = absoluteKey(key);
+    const qsizetype slotCount = m_cacheSlots.size();
+    const qsizetype slot = cacheSlot(absolute);
+    if (slot == slotCount) {
+        // New key: publish a copy of the current snapshot that already has a slot for it
+        const CacheSnapshot* current = m_cache.load();
+        auto* snapshot = current ? new CacheSnapshot(*current) : new CacheSnapshot;
+        snapshot->slotByKey.insert(absolute, slot);
+        snapshot->values.resize(m_cacheSlots.size());
+        snapshot->values[slot] = value(key);
+        publishCache(snapshot);
+    }
+    return KeyHandle(slot);
+}
+
+/**
+ * @brief Writes a value to the store and publishes a new cache snapshot containing it.
+ * @param key The settings key, relative to the current group.
+ * @param value The value to store.
+ */
+void MTSettings::setCachedValue(const QString& key, const QVariant& value) {
+    writeValue(key, value);
+    publishCachedValue(absoluteKey(key), value);
+}
+
+/**
+ * @brief Returns a value from the published cache snapshot without taking a lock. Safe to call from any thread.
+ * @param handle A handle obtained from cacheHandle().
+ * @param defaultValue The value returned when the key is not in the cache.
+ */
+QVariant MTSettings::cachedValue(KeyHandle handle, const QVariant& defaultValue) const {
+    QVariant result = defaultValue;
+
+    const int epoch = beginCacheRead();
+    const CacheSnapshot* snapshot = m_cache.load();
+    if (snapshot && handle.m_slot >= 0 && handle.m_slot < snapshot->values.size()) {
+        const QVariant& value = snapshot->values.at(handle.m_slot);
+        if (value.isValid()) {
+            result = value;
+        }
+    }
+    endCacheRead(epoch);
+
+    return result;
+}
+
+/**
+ * @brief Returns a value from the published cache snapshot without taking a lock. Safe to call from any thread.
+ *
+ * The current group is not applied, since reading it is not thread-safe; use a handle for group-relative keys.
+ * @param key The full settings key, including all groups.
+ * @param defaultValue The value returned when the key is not in the cache.
+ */
+QVariant MTSettings::cachedValue(const QString& key, const QVariant& defaultValue) const {
+    QVariant result = defaultValue;
+
+    const int epoch = beginCacheRead();
+    const CacheSnapshot* snapshot = m_cache.load();
+    if (snapshot) {
+        const qsizetype slot = snapshot->slotByKey.value(key, -1);
+        if (slot >= 0 && slot < snapshot->values.size() && snapshot->values.at(slot).isValid()) {
+            result = snapshot->values.at(slot);
+        }
+    }
+    endCacheRead(epoch);
+
+    return result;
+}
+
+/**
+ * @brief Returns the slot of the key, assigning the next free one to keys not seen before.
+ *        Must be called with the cache write mutex held.
+ */
+qsizetype MTSettings::cacheSlot(const QString& key) {
+    const auto it = m_cacheSlots.constFind(key);
+    if (it != m_cacheSlots.constEnd()) {
+        return it.value();
+    }
+    const qsizetype slot = m_cacheSlots.size();
+    m_cacheSlots.insert(key, slot);
+    return slot;
+}
+
+/**
+ * @brief Publishes a copy of the current snapshot in which the absolute key holds the given value.
+ */
+void MTSettings::publishCachedValue(const QString& key, const QVariant& value) {
+    QMutexLocker locker(&m_cacheWriteMutex);
+
+    const qsizetype slot = cacheSlot(key);
+    const CacheSnapshot* current = m_cache.load();
+    auto* snapshot = current ? new CacheSnapshot(*current) : new CacheSnapshot;
+    snapshot->slotByKey.insert(key, slot);
+    snapshot->values.resize(m_cacheSlots.size());
+    snapshot->values[slot] = value;
+    publishCache(snapshot);
+}
+
+/**
+ * @brief Publishes a copy of the current snapshot without the values of the key and its subkeys.
+ * @param key The removed absolute key; an empty key invalidates every value.
+ */
+void MTSettings::invalidateCache(const QString& key) {
+    QMutexLocker locker(&m_cacheWriteMutex);
+
+    const CacheSnapshot* current = m_cache.load();
+    if (!current) {
+        return;
+    }
+    auto* snapshot = new CacheSnapshot(*current);
+    if (key.isEmpty()) {
+        snapshot->values.fill(QVariant());
+    } else {
+        const QString subkeyPrefix = key + u'/';
+        for (auto it = snapshot->slotByKey.cbegin(); it != snapshot->slotByKey.cend(); ++it) {
+            if (it.key() == key || it.key().startsWith(subkeyPrefix)) {
+                snapshot->values[it.value()] = QVariant();
+            }
+        }
+    }
+    publishCache(snapshot);
+}
+
+/**
+ * @brief Swaps the published snapshot and releases the replaced one once no reader can still hold it.
+ *        Must be called with the cache write mutex held.
+ */
+void MTSettings::publishCache(const CacheSnapshot* snapshot) {
+    const CacheSnapshot* previous = m_cache.exchange(snapshot);
+    if (previous) {
+        waitForCacheReaders();
+        delete previous;
+    }
+}
+
+/**
+ * @brief Registers a reader in the counter of the current epoch and returns the epoch.
+ */
+int MTSettings::beginCacheRead() const {
+    const int epoch = m_cacheEpoch.load() & 1;
+    m_cacheReaders[epoch].fetch_add(1);
+    return epoch;
+}
+
+/**
+ * @brief Unregisters a reader registered by beginCacheRead().
+ */
+void MTSettings::endCacheRead(int epoch) const {
+    m_cacheReaders[epoch].fetch_sub(1);
+}
+
+/**
+ * @brief Waits until no reader that started before the call can still hold a replaced snapshot.
+ *
+ * Readers register in one of two counters chosen by the epoch. Flipping the epoch sends new readers to the
+ * other counter, so the old one drains after the current readers finish, even under constant read load.
+ * A reader may have read the epoch just before a flip and registered right after it, so the epoch is flipped
+ * and drained twice. Readers only copy one value, so the wait is short.
+ */
+void MTSettings::waitForCacheReaders() {
+    for (int flip = 0; flip < 2; ++flip) {
+        const int drained = m_cacheEpoch.fetch_add(1) & 1;
+        while (m_cacheReaders[drained].load() != 0) {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+/**
+ * @brief Writes settings to a file in the specified format without touching any store.
+ * @param format The export format.
+ * @param fileName The name of the file to write.
+ * @param keys The keys to write, in order.
+ * @param valueOf Returns the value for a key; called once per key.
+ * @param progress Optional callback receiving the number of keys written so far; returning false cancels the export.
+ * @return True if the file was written completely, false on error or cancellation.
+ */
+bool MTSettings::writeEntries(ExportFormat format, const QString& fileName, const QStringList& keys,
+                              const ValueGetter& valueOf, const ProgressCallback& progress) {
+    const std::unique_ptr<SettingsWriter> writer = createSettingsWriter(format, fileName);
+    if (!writer || !writer->open()) {
+        if (writer) {
+            writer->abort();
+        }
+        return false;
+    }
+
+    const qint64 total = keys.size();
+    qint64 written = 0;
+    for (const QString& key : keys) {
+        writer->write(key, valueOf(key));
+        if (progress && ++written % ProgressInterval == 0 && !progress(written, total)) {
+            writer->abort();
+            return false;
+        }
+    }
+
+    // Checked once more before close(), which sorts the snapshot key table and compresses staged files
+    if (progress && !progress(written, total)) {
+        writer->abort();
+        return false;
+    }
+    if (!writer->close()) {
+        qWarning() << tr("Failed to write settings to file:") << fileName;
+        return false;
+    }
+    if (progress) {
+        progress(total, total);
+    }
+    return true;
+}
+
+/**
+ * @brief Parses a settings file into a list of key/value pairs without modifying any store.
+ * @param format The import format.
+ * @param fileName The name of the file to read.
+ * @param entries Receives the parsed values in file order.
+ * @param progress Optional callback receiving the parsing position; returning false cancels the import.
+ * @return True if the whole file was parsed successfully, false on error or cancellation.
+ */
+bool MTSettings::readEntries(ExportFormat format, const QString& fileName, SettingsEntries& entries,
+                             const ProgressCallback& progress) {
     QFile file(fileName);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << tr("Failed to open file for reading:") << fileName;
         return false;
     }
 
+    // JSON, XML, CSV and plain text are inflated while they are parsed, so the uncompressed file is never held
+    // in memory. INI (read by QSettings) and snapshots (memory-mapped) cannot be streamed; they are parsed from
+    // an uncompressed temporary copy.
+    const bool compressed = MTGzipDevice::isCompressed(&file);
+    const bool needsPlainFile = format == IniFormat || format == BinarySnapshotFormat;
+    std::optional<MTGzipDevice> inflating;
+    QTemporaryFile inflatedFile;
+    QString sourceName = fileName;
+    if (compressed) {
+        bool decompressed = false;
+        if (needsPlainFile) {
+            decompressed = inflatedFile.open() && MTGzipDevice::decompress(mapFile(file), &inflatedFile);
+            inflatedFile.close();
+            sourceName = inflatedFile.fileName();
+        } else {
+            inflating.emplace(&file);
+            decompressed = inflating->open(QIODevice::ReadOnly);
+        }
+        if (!decompressed) {
+            qWarning() << tr("Failed to decompress file:") << fileName;
+            return false;
+        }
+    }
+    QIODevice* stream = inflating ? &*inflating : nullptr;
+    const QByteArray mapped = stream || needsPlainFile || format == XmlFormat ? QByteArray() : mapFile(file);
+    auto inflateFailed = [&]() {
+        if (inflating && inflating->hasError()) {
+            qWarning() << tr("Failed to decompress file:") << fileName << inflating->errorString();
+            return true;
+        }
+        return false;
+    };
+
+    // Progress is measured in bytes of the file on disk, i.e. compressed bytes for compressed files
+    qint64 parsed = 0;
+    auto cancelled = [&](qint64 done, qint64 total) {
+        return progress && ++parsed % ProgressInterval == 0 && !progress(stream ? file.pos() : done, total);
+    };
+
     if (format == JsonFormat) {
-        QByteArray jsonData = file.readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-        if (!doc.isObject()) {
-            qWarning() << tr("Invalid JSON format in file:") << fileName;
+        // Pull-parse the file member by member instead of building a QJsonDocument
+        JsonObjectReader reader(mapped, stream);
+        QString key;
+        QString value;
+        while (reader.readNext(key, value)) {
+            entries.append(qMakePair(key, QVariant(value)));
+            if (cancelled(reader.position(), file.size())) {
+                return false;
+            }
+        }
+        if (inflateFailed()) {
             return false;
         }
-        QJsonObject json = doc.object();
-        for (auto it = json.begin(); it != json.end(); ++it) {
-            setValue(it.key(), it.value().toString());
+        if (reader.hasError()) {
+            qWarning() << tr("Invalid JSON format in file:") << fileName << reader.errorString();
+            return false;
         }
     } else if (format == IniFormat) {
-        QSettings iniSettings(fileName, QSettings::IniFormat);
-        for (const QString& key : iniSettings.allKeys()) {
-            setValue(key, iniSettings.value(key));
+        QSettings iniSettings(sourceName, QSettings::IniFormat);
+        if (iniSettings.status() != QSettings::NoError) {
+            qWarning() << tr("Invalid INI format in file:") << fileName;
+            return false;
+        }
+        const QStringList keys = iniSettings.allKeys();
+        entries.reserve(entries.size() + keys.size());
+        for (const QString& key : keys) {
+            entries.append(qMakePair(key, iniSettings.value(key)));
+            if (cancelled(entries.size(), keys.size())) {
+                return false;
+            }
         }
     } else if (format == XmlFormat) {
-        QDomDocument doc;
-        if (!doc.setContent(&file)) {
-            qWarning() << tr("Invalid XML format in file:") << fileName;
+        QXmlStreamReader xml(stream ? stream : &file);
+        if (xml.readNextStartElement()) {
+            while (xml.readNextStartElement()) {
+                if (xml.name() == u"Setting") {
+                    const QXmlStreamAttributes attributes = xml.attributes();
+                    entries.append(qMakePair(attributes.value(u"key").toString(), QVariant(attributes.value(u"value").toString())));
+                }
+                xml.skipCurrentElement();
+                if (cancelled(file.pos(), file.size())) {
+                    return false;
+                }
+            }
+        }
+        if (inflateFailed()) {
             return false;
         }
-        QDomElement root = doc.documentElement();
-        QDomNode node = root.firstChild();
-        while (!node.isNull()) {
-            QDomElement element = node.toElement();
-            if (!element.isNull() && element.tagName() == "Setting") {
-                QString key = element.attribute("key");
-                QString value = element.attribute("value");
-                setValue(key, value);
-            }
-            node = node.nextSibling();
+        if (xml.hasError()) {
+            qWarning() << tr("Invalid XML format in file:") << fileName << xml.errorString();
+            return false;
         }
     } else if (format == CsvFormat || format == PlainTextFormat) {
-        QTextStream in(&file);
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList parts = format == CsvFormat ? line.split(",") : line.split("=");
-            if (parts.size() == 2) {
-                setValue(parts[0], parts[1]);
+        // Fields are sliced straight out of the mapped file or the inflated chunk; only the final key and value
+        // become QStrings
+        DelimitedReader reader(mapped, format == CsvFormat ? DelimitedReader::Csv : DelimitedReader::KeyValue, stream);
+        QString key;
+        QString value;
+        while (reader.readNext(key, value)) {
+            entries.append(qMakePair(key, QVariant(value)));
+            if (cancelled(reader.position(), file.size())) {
+                return false;
+            }
+        }
+        if (inflateFailed()) {
+            return false;
+        }
+        if (reader.hasError()) {
+            qWarning() << tr("Invalid text format in file:") << fileName << reader.errorString();
+            return false;
+        }
+    } else if (format == BinarySnapshotFormat) {
+        file.close();
+        MTSettingsSnapshot snapshot;
+        if (!snapshot.open(sourceName)) {
+            return false;
+        }
+        entries.reserve(entries.size() + snapshot.size());
+        for (qsizetype i = 0; i < snapshot.size(); ++i) {
+            // A stored invalid QVariant is restored as a removal; only undecodable entries fail the file
+            bool decoded = false;
+            const QVariant value = snapshot.valueAt(i, &decoded);
+            if (!decoded) {
+                qWarning() << tr("Invalid snapshot entry in file:") << fileName;
+                return false;
+            }
+            entries.append(qMakePair(snapshot.keyAt(i), value));
+            if (cancelled(i + 1, snapshot.size())) {
+                return false;
             }
         }
+    } else {
+        qWarning() << tr("Unknown import format:") << int(format);
+        return false;
+    }
+
+    if (progress) {
+        progress(file.size(), file.size());
     }
 
     file.close();
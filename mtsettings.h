@@ -1,16 +1,38 @@
 #ifndef MTSETTINGS_H
 #define MTSETTINGS_H
 
+#include "mtsettingskeyindex.h"
+
 #include <QSettings>
+#include <QFuture>
 #include <QString>
 #include <QStringList>
 #include <QVariant>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+#include <QSet>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QFileSystemWatcher;
+class QTimer;
+class MTSettingsSnapshot;
 
 /**
  * @class MTSettings
  * @brief An extended QSettings class with additional functionality for exporting and importing settings.
+ *
+ * setValue(), remove() and clear() hide the QSettings functions rather than override them, because they are not
+ * virtual. Writes made through a QSettings pointer or reference bypass the key index and the read cache.
  */
 class MTSettings : public QSettings {
+    Q_OBJECT
+
 public:
     /**
      * @brief Supported export and import formats.
@@ -20,7 +42,25 @@ public:
         IniFormat,       ///< INI format
         XmlFormat,       ///< XML format
         CsvFormat,       ///< CSV format
-        PlainTextFormat  ///< Plain text format
+        PlainTextFormat, ///< Plain text format
+        BinarySnapshotFormat ///< Binary, type-preserving snapshot that can be memory-mapped (see MTSettingsSnapshot)
+    };
+
+    /**
+     * @brief How the key list passed to exportSettings() is interpreted.
+     */
+    enum KeySelection {
+        ExactKeys,      ///< Each entry is a key
+        GroupPrefixes,  ///< Each entry is a group; the group key itself and every key below it are selected
+        GlobPatterns    ///< Each entry is a glob pattern matched group by group ('**' spans groups)
+    };
+
+    /**
+     * @brief One destination of a multi-format export.
+     */
+    struct ExportTarget {
+        ExportFormat format;  ///< The export format
+        QString fileName;     ///< The name of the file to export to
     };
 
     /**
@@ -30,25 +70,368 @@ public:
      */
     MTSettings(const QString& organization, const QString& application);
 
+    /**
+     * @brief Constructs an MTSettings object stored in the given file.
+     * @param fileName The name of the settings file.
+     * @param format The storage format, e.g. QSettings::IniFormat.
+     */
+    MTSettings(const QString& fileName, QSettings::Format format);
+
+    /**
+     * @brief Destroys the object and releases all cache snapshots.
+     */
+    ~MTSettings();
+
+    /**
+     * @class KeyHandle
+     * @brief Precomputed reference to a cached key. Lookups through a handle index the cache snapshot directly
+     *        instead of hashing the key string.
+     */
+    class KeyHandle {
+    public:
+        KeyHandle() = default;
+
+        /**
+         * @brief Returns true if the handle was obtained from cacheHandle().
+         */
+        bool isValid() const { return m_slot >= 0; }
+
+    private:
+        friend class MTSettings;
+        explicit KeyHandle(qsizetype slot) : m_slot(slot) {}
+
+        qsizetype m_slot = -1;
+    };
+
     /**
      * @brief Exports settings to a file in the specified format.
-     * @param format The export format (e.g., JSON, INI, XML, CSV, or Plain Text).
+     *
+     * JSON and XML output is streamed key by key, so memory use does not depend on the number of keys.
+     * CSV and plain text fields containing the separator, quotes or line breaks are quoted as in RFC 4180.
+     * If fileName ends with ".gz", the output is gzip-compressed while it is written.
+     * @param format The export format (e.g., JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
      * @param fileName The name of the file to export to.
      * @param keysToExport The list of keys to export. If empty, exports all keys.
+     * @param selection How the entries of keysToExport are interpreted.
      * @return True if the export was successful, false otherwise.
      */
-    bool exportSettings(ExportFormat format, const QString& fileName, const QStringList& keysToExport = QStringList());
+    bool exportSettings(ExportFormat format, const QString& fileName, const QStringList& keysToExport = QStringList(),
+                        KeySelection selection = ExactKeys);
+
+    /**
+     * @brief Exports the same keys to several files in a single pass over the store.
+     *
+     * Every value is read once and passed to the writers of all targets. With parallelWriters, values are read
+     * in batches on the calling thread and each batch is written by all writers concurrently in the thread pool.
+     * @param targets The formats and files to export to.
+     * @param keysToExport The list of keys to export. If empty, exports all keys.
+     * @param selection How the entries of keysToExport are interpreted.
+     * @param parallelWriters True to run the writers on worker threads. INI writers, which use QSettings, stay on
+     *        the calling thread.
+     * @return True if all files were written successfully, false otherwise.
+     */
+    bool exportSettings(const QList<ExportTarget>& targets, const QStringList& keysToExport = QStringList(),
+                        KeySelection selection = ExactKeys, bool parallelWriters = false);
 
     /**
      * @brief Imports settings from a file in the specified format.
-     * @param format The import format (e.g., JSON, INI, XML, CSV, or Plain Text).
+     *
+     * JSON and XML input is pull-parsed without building a document tree; CSV and plain text are parsed
+     * in place over the memory-mapped file and accept RFC 4180 quoting. The import is all-or-nothing:
+     * values are staged in memory, applied in one pass and synchronized once.
+     * Gzip-compressed files are detected by their header and decompressed transparently: JSON, XML, CSV and plain
+     * text are inflated chunk by chunk while they are parsed, INI and snapshots through an uncompressed temporary file.
+     * @param format The import format (e.g., JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
      * @param fileName The name of the file to import from.
      * @return True if the import was successful, false otherwise.
      */
     bool importSettings(ExportFormat format, const QString& fileName);
 
+    /**
+     * @brief Memory-maps a binary snapshot for on-demand lookups with snapshotValue().
+     *
+     * Nothing is copied into the store: only the header is read on open and each value is decoded the first
+     * time it is requested. Gzip-compressed snapshots cannot be mapped and must be imported instead.
+     * @param fileName The name of the snapshot file.
+     * @return True if the snapshot was opened, false otherwise.
+     */
+    bool openSnapshot(const QString& fileName);
+
+    /**
+     * @brief Unmaps the snapshot opened with openSnapshot().
+     */
+    void closeSnapshot();
+
+    /**
+     * @brief Returns true if a snapshot is open for on-demand lookups.
+     */
+    bool isSnapshotOpen() const;
+
+    /**
+     * @brief Returns a value from the open snapshot, decoding it on first access.
+     * @param key The settings key, relative to the current group.
+     * @param defaultValue The value returned when no snapshot is open or the key is missing or holds an invalid value.
+     */
+    QVariant snapshotValue(const QString& key, const QVariant& defaultValue = QVariant()) const;
+
+    /**
+     * @brief Exports settings to a file on a worker thread.
+     *
+     * The keys and their values are read on the calling thread; formatting and writing happen in the thread pool.
+     * The returned future reports progress from 0 to 1000 (per mille of the keys written) and can be cancelled,
+     * in which case the file is removed. Must be called on the thread that owns this object.
+     * @param format The export format.
+     * @param fileName The name of the file to export to.
+     * @param keysToExport The list of keys to export. If empty, exports all keys.
+     * @param selection How the entries of keysToExport are interpreted.
+     * @return A future holding true if the export was successful.
+     */
+    QFuture<bool> exportSettingsAsync(ExportFormat format, const QString& fileName, const QStringList& keysToExport = QStringList(),
+                                      KeySelection selection = ExactKeys);
+
+    /**
+     * @brief Resolves group prefixes or glob patterns to the matching keys using the key index.
+     *
+     * The index is built from allKeys() on first use and then kept up to date by setValue(), remove() and clear()
+     * of this class. Keys removed through a QSettings pointer or reference, or by another process, are filtered out
+     * of the result; keys added that way are only found after rebuildKeyIndex().
+     * @param patterns The group prefixes or glob patterns.
+     * @param selection How the patterns are interpreted; ExactKeys returns the keys that exist.
+     * @return The matching keys without duplicates.
+     */
+    QStringList matchingKeys(const QStringList& patterns, KeySelection selection);
+
+    /**
+     * @brief Rebuilds the key index from allKeys().
+     */
+    void rebuildKeyIndex();
+
+    /**
+     * @brief Sets the value of a key and keeps the key index and the read cache up to date. Hides QSettings::setValue().
+     */
+    void setValue(const QString& key, const QVariant& value);
+
+    /**
+     * @brief Removes a key and its subkeys and keeps the key index and the read cache up to date. Hides QSettings::remove().
+     */
+    void remove(const QString& key);
+
+    /**
+     * @brief Removes all keys of the store, not only those of the current group, like QSettings::clear(),
+     *        and resets the key index and the read cache. Hides QSettings::clear().
+     */
+    void clear();
+
+    /**
+     * @brief Imports settings from a file, parsing it on a worker thread.
+     *
+     * Only the parsing runs in the thread pool. The parsed values are written back in one batch on the thread
+     * that owns this object. The returned future reports parsing progress in per mille and can be cancelled;
+     * a cancelled import leaves the store untouched. Must be called on the thread that owns this object, whose
+     * event loop delivers the parsed values.
+     * @param format The import format.
+     * @param fileName The name of the file to import from.
+     * @return A future holding true if the import was successful.
+     */
+    QFuture<bool> importSettingsAsync(ExportFormat format, const QString& fileName);
+
+    /**
+     * @brief Starts a transaction. Values passed to stageValue() are kept in memory until commitTransaction().
+     * @return True if the transaction was started, false if another transaction is already active.
+     */
+    bool beginTransaction();
+
+    /**
+     * @brief Stages a value in the active transaction.
+     * @param key The settings key.
+     * @param value The value to store on commit. An invalid QVariant removes the key on commit.
+     * @return True if the value was staged, false if no transaction is active.
+     */
+    bool stageValue(const QString& key, const QVariant& value);
+
+    /**
+     * @brief Stages the removal of a key in the active transaction.
+     * @param key The settings key.
+     * @return True if the removal was staged, false if no transaction is active.
+     */
+    bool stageRemove(const QString& key);
+
+    /**
+     * @brief Applies all staged values in one pass and synchronizes the store once.
+     * @return True if the store was written without errors, false otherwise.
+     */
+    bool commitTransaction();
+
+    /**
+     * @brief Discards all staged values and ends the transaction without touching the store.
+     */
+    void rollbackTransaction();
+
+    /**
+     * @brief Returns true if a transaction is active.
+     */
+    bool isTransactionActive() const;
+
+    /**
+     * @brief Appends the changes made since the previous delta export to a journal file.
+     *
+     * A content hash of every key is kept in a state file next to the journal (<journal>.state).
+     * Only added, changed and removed keys are written, as one committed batch of JSON lines.
+     * The first call writes every key and serves as the base snapshot.
+     * @param journalFileName The name of the journal file to append to.
+     * @return True if the journal and the state file were written successfully, false otherwise.
+     */
+    bool exportDelta(const QString& journalFileName);
+
+    /**
+     * @brief Replays a delta journal onto the store in one transaction.
+     * @param journalFileName The name of the journal file to replay.
+     * @return True if the journal was replayed successfully, false otherwise.
+     */
+    bool importDelta(const QString& journalFileName);
+
+    /**
+     * @brief Rebuilds the read cache from the whole store, not only the current group, and publishes it to readers.
+     *
+     * Readers keep using the previous snapshot until they finish; it is released as soon as they have left it.
+     * The cache is also rebuilt by commitTransaction() once it has been published.
+     */
+    void refreshCache();
+
+    /**
+     * @brief Returns a handle for repeated cached lookups of the key.
+     *
+     * Handles stay valid for the lifetime of the object, also for keys that are added to the store later.
+     * @param key The settings key, relative to the current group.
+     */
+    KeyHandle cacheHandle(const QString& key);
+
+    /**
+     * @brief Writes a value to the store and publishes a new cache snapshot containing it.
+     * @param key The settings key, relative to the current group.
+     * @param value The value to store.
+     */
+    void setCachedValue(const QString& key, const QVariant& value);
+
+    /**
+     * @brief Returns a value from the published cache snapshot without taking a lock. Safe to call from any thread.
+     * @param handle A handle obtained from cacheHandle().
+     * @param defaultValue The value returned when the key is not in the cache.
+     */
+    QVariant cachedValue(KeyHandle handle, const QVariant& defaultValue = QVariant()) const;
+
+    /**
+     * @brief Returns a value from the published cache snapshot without taking a lock. Safe to call from any thread.
+     *
+     * The current group is not applied, since reading it is not thread-safe; use a handle for group-relative keys.
+     * @param key The full settings key, including all groups.
+     * @param defaultValue The value returned when the key is not in the cache.
+     */
+    QVariant cachedValue(const QString& key, const QVariant& defaultValue = QVariant()) const;
+
+    /**
+     * @brief Typed variant of cachedValue().
+     * @param handle A handle obtained from cacheHandle().
+     * @param defaultValue The value returned when the key is not in the cache.
+     */
+    template <typename T>
+    T cachedValueAs(KeyHandle handle, const T& defaultValue = T()) const {
+        const QVariant value = cachedValue(handle);
+        return value.isValid() ? value.value<T>() : defaultValue;
+    }
+
+    /**
+     * @brief Keeps the store in sync with an external file that may be edited while the application runs.
+     *
+     * The file is loaded immediately and again whenever it changes on disk. Bursts of writes are coalesced:
+     * the file is re-parsed once no change has been seen for debounceMs milliseconds. Only keys whose value
+     * differs from the store are written, in one batch, and valueChanged() is emitted for each of them.
+     * Keys that disappear from the file are removed. Replacing the file (save via rename) is also detected.
+     * @param format The file format (JSON, INI, XML, CSV, Plain Text or Binary Snapshot).
+     * @param fileName The name of the file to watch.
+     * @param debounceMs The quiet period after the last change before the file is reloaded.
+     * @return True if the file was loaded and is being watched, false otherwise.
+     */
+    bool watchFile(ExportFormat format, const QString& fileName, int debounceMs = 250);
+
+    /**
+     * @brief Stops watching the file passed to watchFile(). The store keeps its current values.
+     */
+    void stopWatching();
+
+    /**
+     * @brief Returns true if a file is being watched.
+     */
+    bool isWatching() const;
+
+signals:
+    /**
+     * @brief Emitted after a reload of the watched file for every key whose value changed.
+     * @param key The settings key.
+     * @param value The new value, or an invalid QVariant if the key was removed.
+     */
+    void valueChanged(const QString& key, const QVariant& value);
+
 private:
-         // No additional members needed since QSettings handles storage.
+    using SettingsEntries = QList<QPair<QString, QVariant>>;
+    using ValueGetter = std::function<QVariant(const QString&)>;
+    using ProgressCallback = std::function<bool(qint64 done, qint64 total)>;
+
+    /**
+     * @brief Immutable cache snapshot. Never modified after it has been published.
+     */
+    struct CacheSnapshot {
+        QHash<QString, qsizetype> slotByKey;  ///< Key to slot index
+        QList<QVariant> values;               ///< Values by slot, invalid for keys missing from the store
+    };
+
+    SettingsEntries m_stagedValues;    ///< Values staged by the active transaction
+    bool m_transactionActive = false;  ///< True between beginTransaction() and commit/rollback
+
+    std::unique_ptr<MTSettingsSnapshot> m_snapshot;  ///< Snapshot opened by openSnapshot(), if any
+
+    MTSettingsKeyIndex m_keyIndex;     ///< Hierarchical index of all keys, built on first use
+    bool m_keyIndexBuilt = false;
+
+    std::atomic<const CacheSnapshot*> m_cache { nullptr };  ///< Snapshot currently published to readers
+    mutable std::atomic<int> m_cacheReaders[2] { { 0 }, { 0 } };  ///< Readers inside cachedValue(), by epoch parity
+    std::atomic<int> m_cacheEpoch { 0 };                    ///< Selects the reader counter new readers register in
+    QHash<QString, qsizetype> m_cacheSlots;                 ///< Slot assigned to every key seen by the cache
+    QMutex m_cacheWriteMutex;                               ///< Serializes cache writers
+
+    QFileSystemWatcher* m_watcher = nullptr;  ///< Watches the file and its directory while watchFile() is active
+    QTimer* m_reloadTimer = nullptr;          ///< Debounces change notifications
+    ExportFormat m_watchFormat = JsonFormat;
+    QString m_watchedFile;
+    QSet<QString> m_watchedKeys;              ///< Keys present in the watched file at the last reload
+
+    bool reloadWatchedFile();
+
+    void writeValue(const QString& key, const QVariant& value);
+    void removeValue(const QString& key);
+
+    qsizetype cacheSlot(const QString& key);
+    void publishCachedValue(const QString& key, const QVariant& value);
+    void invalidateCache(const QString& key);
+    void publishCache(const CacheSnapshot* snapshot);
+    int beginCacheRead() const;
+    void endCacheRead(int epoch) const;
+    void waitForCacheReaders();
+
+    bool applyEntries(SettingsEntries entries);
+    QStringList keysFor(const QStringList& keysToExport, KeySelection selection);
+    QString absoluteKey(const QString& key) const;
+    QStringList leaveGroups();
+    void restoreGroups(const QStringList& openGroups);
+
+    static QByteArray deltaHash(const QVariant& value);
+    static void appendDeltaRecord(QByteArray& out, const QString& op, const QString& key, const QVariant& value);
+    static QVariant deltaValue(const QJsonObject& record);
+
+    static bool writeEntries(ExportFormat format, const QString& fileName, const QStringList& keys,
+                             const ValueGetter& valueOf, const ProgressCallback& progress = ProgressCallback());
+    static bool readEntries(ExportFormat format, const QString& fileName, SettingsEntries& entries,
+                            const ProgressCallback& progress = ProgressCallback());
 };
 
 #endif // MTSETTINGS_H
@@ -0,0 +1,235 @@
+#include "mtsettingskeyindex.h"
+#include <QList>
+#include <QRegularExpression>
+
+/**
+ * @brief Trie node; a node is a key when isKey is set, and a group when it has children.
+ */
+struct MTSettingsKeyIndex::Node {
+    std::map<QString, std::unique_ptr<Node>> children;
+    bool isKey = false;
+    qsizetype keyCount = 0;  ///< Number of keys in this subtree, including the node itself
+};
+
+namespace {
+
+/**
+ * @brief Glob pattern split into segments; wildcard segments carry a compiled expression.
+ */
+struct GlobSegment {
+    QString text;
+    QRegularExpression expression;
+    bool isLiteral = true;
+    bool isRecursive = false;
+};
+
+bool hasWildcard(const QString& segment) {
+    for (const QChar c : segment) {
+        if (c == u'*' || c == u'?' || c == u'[') {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty index.
+ */
+MTSettingsKeyIndex::MTSettingsKeyIndex()
+    : m_root(std::make_unique<Node>()) {}
+
+/**
+ * @brief Destroys the index.
+ */
+MTSettingsKeyIndex::~MTSettingsKeyIndex() = default;
+
+/**
+ * @brief Adds a key to the index.
+ */
+void MTSettingsKeyIndex::insert(const QString& key) {
+    const QStringList segments = split(key);
+    if (segments.isEmpty()) {
+        return;
+    }
+
+    QList<Node*> path;
+    path.reserve(segments.size() + 1);
+    Node* node = m_root.get();
+    path.append(node);
+    for (const QString& segment : segments) {
+        std::unique_ptr<Node>& child = node->children[segment];
+        if (!child) {
+            child = std::make_unique<Node>();
+        }
+        node = child.get();
+        path.append(node);
+    }
+
+    if (node->isKey) {
+        return;
+    }
+    node->isKey = true;
+    for (Node* visited : path) {
+        ++visited->keyCount;
+    }
+    ++m_size;
+}
+
+/**
+ * @brief Removes a key and every key below it, mirroring QSettings::remove().
+ */
+void MTSettingsKeyIndex::remove(const QString& key) {
+    const QStringList segments = split(key);
+    if (segments.isEmpty()) {
+        clear();
+        return;
+    }
+
+    QList<Node*> path;
+    path.reserve(segments.size());
+    Node* node = m_root.get();
+    for (const QString& segment : segments) {
+        const auto it = node->children.find(segment);
+        if (it == node->children.end()) {
+            return;
+        }
+        path.append(node);
+        node = it->second.get();
+    }
+
+    const qsizetype removed = node->keyCount;
+    for (Node* visited : path) {
+        visited->keyCount -= removed;
+    }
+    m_size -= removed;
+
+    // Drop the subtree and every ancestor group that became empty
+    for (qsizetype i = path.size() - 1; i >= 0; --i) {
+        path[i]->children.erase(segments[i]);
+        if (path[i]->keyCount > 0 || path[i]->isKey || i == 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Removes all keys.
+ */
+void MTSettingsKeyIndex::clear() {
+    m_root = std::make_unique<Node>();
+    m_size = 0;
+}
+
+/**
+ * @brief Returns true if the key is in the index.
+ */
+bool MTSettingsKeyIndex::contains(const QString& key) const {
+    const Node* node = find(split(key));
+    return node && node->isKey;
+}
+
+/**
+ * @brief Returns the number of keys in the index.
+ */
+qsizetype MTSettingsKeyIndex::size() const {
+    return m_size;
+}
+
+/**
+ * @brief Appends the group itself (if it is a key) and all keys below it, in sorted order.
+ * @param group The group prefix, e.g. "network/proxy".
+ * @param keys Receives the matching keys.
+ */
+void MTSettingsKeyIndex::collectGroup(const QString& group, QStringList& keys) const {
+    const QStringList segments = split(group);
+    const Node* node = find(segments);
+    if (!node) {
+        return;
+    }
+
+    keys.reserve(keys.size() + node->keyCount);
+    const auto collect = [&keys](const auto& self, const Node* current, const QString& path) -> void {
+        if (current->isKey) {
+            keys.append(path);
+        }
+        for (const auto& [segment, child] : current->children) {
+            self(self, child.get(), path.isEmpty() ? segment : path + u'/' + segment);
+        }
+    };
+    collect(collect, node, segments.join(u'/'));
+}
+
+/**
+ * @brief Appends all keys matching a glob pattern, in sorted order.
+ * @param pattern The glob pattern.
+ * @param keys Receives the matching keys.
+ */
+void MTSettingsKeyIndex::collectGlob(const QString& pattern, QStringList& keys) const {
+    QList<GlobSegment> segments;
+    for (const QString& text : split(pattern)) {
+        GlobSegment segment;
+        segment.text = text;
+        segment.isRecursive = text == QStringLiteral("**");
+        segment.isLiteral = !segment.isRecursive && !hasWildcard(text);
+        if (!segment.isLiteral && !segment.isRecursive) {
+            segment.expression = QRegularExpression(QRegularExpression::wildcardToRegularExpression(
+                text, QRegularExpression::NonPathWildcardConversion));
+        }
+        segments.append(segment);
+    }
+    if (segments.isEmpty()) {
+        return;
+    }
+
+    const auto match = [&](const auto& self, const Node* node, qsizetype index, const QString& path) -> void {
+        if (index == segments.size()) {
+            if (node->isKey) {
+                keys.append(path);
+            }
+            return;
+        }
+
+        const auto childPath = [&path](const QString& segment) {
+            return path.isEmpty() ? segment : path + u'/' + segment;
+        };
+
+        const GlobSegment& segment = segments[index];
+        if (segment.isLiteral) {
+            const auto it = node->children.find(segment.text);
+            if (it != node->children.end()) {
+                self(self, it->second.get(), index + 1, childPath(segment.text));
+            }
+        } else if (segment.isRecursive) {
+            // "**" matches zero groups here, or one group and stays active below it
+            self(self, node, index + 1, path);
+            for (const auto& [name, child] : node->children) {
+                self(self, child.get(), index, childPath(name));
+            }
+        } else {
+            for (const auto& [name, child] : node->children) {
+                if (segment.expression.match(name).hasMatch()) {
+                    self(self, child.get(), index + 1, childPath(name));
+                }
+            }
+        }
+    };
+    match(match, m_root.get(), 0, QString());
+}
+
+QStringList MTSettingsKeyIndex::split(const QString& key) {
+    return key.split(u'/', Qt::SkipEmptyParts);
+}
+
+const MTSettingsKeyIndex::Node* MTSettingsKeyIndex::find(const QStringList& segments) const {
+    const Node* node = m_root.get();
+    for (const QString& segment : segments) {
+        const auto it = node->children.find(segment);
+        if (it == node->children.end()) {
+            return nullptr;
+        }
+        node = it->second.get();
+    }
+    return node;
+}
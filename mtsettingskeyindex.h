@@ -0,0 +1,84 @@
+#ifndef MTSETTINGSKEYINDEX_H
+#define MTSETTINGSKEYINDEX_H
+
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <memory>
+
+/**
+ * @class MTSettingsKeyIndex
+ * @brief Trie of settings keys split into '/'-separated groups.
+ *
+ * Group prefixes and glob patterns are resolved by walking only the matching branches,
+ * so the cost depends on the number of matches rather than on the number of keys.
+ */
+class MTSettingsKeyIndex {
+public:
+    /**
+     * @brief Constructs an empty index.
+     */
+    MTSettingsKeyIndex();
+
+    /**
+     * @brief Destroys the index.
+     */
+    ~MTSettingsKeyIndex();
+
+    MTSettingsKeyIndex(const MTSettingsKeyIndex&) = delete;
+    MTSettingsKeyIndex& operator=(const MTSettingsKeyIndex&) = delete;
+
+    /**
+     * @brief Adds a key to the index.
+     */
+    void insert(const QString& key);
+
+    /**
+     * @brief Removes a key and every key below it, mirroring QSettings::remove().
+     */
+    void remove(const QString& key);
+
+    /**
+     * @brief Removes all keys.
+     */
+    void clear();
+
+    /**
+     * @brief Returns true if the key is in the index.
+     */
+    bool contains(const QString& key) const;
+
+    /**
+     * @brief Returns the number of keys in the index.
+     */
+    qsizetype size() const;
+
+    /**
+     * @brief Appends the group itself (if it is a key) and all keys below it, in sorted order.
+     * @param group The group prefix, e.g. "network/proxy".
+     * @param keys Receives the matching keys.
+     */
+    void collectGroup(const QString& group, QStringList& keys) const;
+
+    /**
+     * @brief Appends all keys matching a glob pattern, in sorted order.
+     *
+     * The pattern is matched group by group: '*', '?' and '[...]' never cross a '/',
+     * and a "**" segment matches any number of groups.
+     * @param pattern The glob pattern, e.g. "network/ * /port" or "ui/ ** /color" (without the spaces).
+     * @param keys Receives the matching keys.
+     */
+    void collectGlob(const QString& pattern, QStringList& keys) const;
+
+private:
+    struct Node;
+
+    std::unique_ptr<Node> m_root;
+    qsizetype m_size = 0;
+
+    static QStringList split(const QString& key);
+    const Node* find(const QStringList& segments) const;
+};
+
+#endif // MTSETTINGSKEYINDEX_H
@@ -0,0 +1,321 @@
+#include "mtsettingssnapshot.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/*
+ * File layout, all integers little-endian:
+ *
+ *   header   "MTSS", quint32 version, quint32 entry count, quint32 reserved,
+ *            quint64 table offset, quint64 key blob offset
+ *   values   QDataStream-serialized QVariants, one per entry, in the order they were written
+ *   keys     UTF-8 key bytes, in key order
+ *   table    per entry: quint32 key offset (relative to the key blob), quint32 key length,
+ *            quint64 value offset, quint32 value length, quint32 reserved
+ */
+constexpr char Magic[4] = { 'M', 'T', 'S', 'S' };
+constexpr quint32 FormatVersion = 1;
+constexpr qint64 HeaderSize = 32;
+constexpr qint64 EntrySize = 24;
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_5;
+
+template <typename T>
+void appendLittleEndian(QByteArray& out, T value) {
+    char buffer[sizeof(T)];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, sizeof(T));
+}
+
+int compareBytes(QByteArrayView a, QByteArrayView b) {
+    const qsizetype length = std::min(a.size(), b.size());
+    if (length > 0) {
+        if (const int result = std::memcmp(a.data(), b.data(), length)) {
+            return result;
+        }
+    }
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a closed snapshot.
+ */
+MTSettingsSnapshot::MTSettingsSnapshot() = default;
+
+/**
+ * @brief Unmaps and closes the snapshot file.
+ */
+MTSettingsSnapshot::~MTSettingsSnapshot() {
+    close();
+}
+
+/**
+ * @brief Memory-maps a snapshot file.
+ * @param fileName The name of the snapshot file.
+ * @return True if the file is a valid snapshot and was mapped, false otherwise.
+ */
+bool MTSettingsSnapshot::open(const QString& fileName) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << QCoreApplication::translate("MTSettingsSnapshot", "Failed to open file for reading:") << fileName;
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size >= HeaderSize) {
+        m_data = m_file.map(0, m_size);
+    }
+    if (!m_data || std::memcmp(m_data, Magic, sizeof(Magic)) != 0
+        || qFromLittleEndian<quint32>(m_data + 4) != FormatVersion) {
+        qWarning() << QCoreApplication::translate("MTSettingsSnapshot", "Invalid snapshot format in file:") << fileName;
+        close();
+        return false;
+    }
+
+    m_count = qFromLittleEndian<quint32>(m_data + 8);
+    m_tableOffset = static_cast<qint64>(qFromLittleEndian<quint64>(m_data + 16));
+    m_keysOffset = static_cast<qint64>(qFromLittleEndian<quint64>(m_data + 24));
+    if (m_keysOffset < HeaderSize || m_tableOffset < m_keysOffset || m_tableOffset + m_count * EntrySize != m_size) {
+        qWarning() << QCoreApplication::translate("MTSettingsSnapshot", "Corrupted snapshot table in file:") << fileName;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Unmaps the file and drops all decoded values.
+ */
+void MTSettingsSnapshot::close() {
+    m_decoded.clear();
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_count = 0;
+    m_tableOffset = 0;
+    m_keysOffset = 0;
+}
+
+/**
+ * @brief Returns true if a snapshot is mapped.
+ */
+bool MTSettingsSnapshot::isOpen() const {
+    return m_data != nullptr;
+}
+
+/**
+ * @brief Returns the number of keys in the snapshot.
+ */
+qsizetype MTSettingsSnapshot::size() const {
+    return m_count;
+}
+
+/**
+ * @brief Returns true if the snapshot contains the key.
+ */
+bool MTSettingsSnapshot::contains(const QString& key) const {
+    return indexOf(key.toUtf8()) >= 0;
+}
+
+/**
+ * @brief Returns the value stored for the key, decoding it on first access.
+ * @param key The settings key.
+ * @param defaultValue The value returned when the key is not present.
+ */
+QVariant MTSettingsSnapshot::value(const QString& key, const QVariant& defaultValue) const {
+    const qsizetype index = indexOf(key.toUtf8());
+    return index >= 0 ? valueAt(index) : defaultValue;
+}
+
+/**
+ * @brief Returns the key stored at the given position of the sorted table.
+ */
+QString MTSettingsSnapshot::keyAt(qsizetype index) const {
+    return QString::fromUtf8(keyBytes(index));
+}
+
+/**
+ * @brief Returns the value stored at the given position of the sorted table, decoding it on first access.
+ * @param index The position in the table.
+ * @param ok If not null, set to false when the entry is out of range or its value cannot be decoded.
+ *           A stored invalid QVariant is decoded successfully.
+ */
+QVariant MTSettingsSnapshot::valueAt(qsizetype index, bool* ok) const {
+    if (ok) {
+        *ok = false;
+    }
+    const uchar* e = entry(index);
+    if (!e) {
+        return QVariant();
+    }
+
+    const auto cached = m_decoded.constFind(index);
+    if (cached != m_decoded.constEnd()) {
+        if (ok) {
+            *ok = true;
+        }
+        return cached.value();
+    }
+
+    const qint64 offset = static_cast<qint64>(qFromLittleEndian<quint64>(e + 8));
+    const qint64 length = qFromLittleEndian<quint32>(e + 16);
+    if (offset < HeaderSize || offset + length > m_keysOffset) {
+        qWarning() << QCoreApplication::translate("MTSettingsSnapshot", "Corrupted snapshot value for key:") << keyAt(index);
+        return QVariant();
+    }
+
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(m_data + offset), length);
+    QDataStream stream(bytes);
+    stream.setVersion(StreamVersion);
+    QVariant value;
+    stream >> value;
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << QCoreApplication::translate("MTSettingsSnapshot", "Corrupted snapshot value for key:") << keyAt(index);
+        return QVariant();
+    }
+
+    m_decoded.insert(index, value);
+    if (ok) {
+        *ok = true;
+    }
+    return value;
+}
+
+/**
+ * @brief Returns all keys in table order.
+ */
+QStringList MTSettingsSnapshot::keys() const {
+    QStringList result;
+    result.reserve(m_count);
+    for (qsizetype i = 0; i < m_count; ++i) {
+        result.append(keyAt(i));
+    }
+    return result;
+}
+
+/**
+ * @brief Constructs a writer for an open, seekable file.
+ */
+MTSettingsSnapshot::Writer::Writer(QFile& file)
+    : m_file(file) {}
+
+/**
+ * @brief Writes the header placeholder. Must be called before add().
+ */
+bool MTSettingsSnapshot::Writer::begin() {
+    m_entries.clear();
+    return m_file.write(QByteArray(HeaderSize, '\0')) == HeaderSize;
+}
+
+/**
+ * @brief Appends a value to the snapshot.
+ */
+bool MTSettingsSnapshot::Writer::add(const QString& key, const QVariant& value) {
+    m_valueBytes.truncate(0);
+    {
+        QDataStream stream(&m_valueBytes, QIODevice::WriteOnly);
+        stream.setVersion(StreamVersion);
+        stream << value;
+    }
+
+    m_entries.append({ key.toUtf8(), static_cast<quint64>(m_file.pos()), static_cast<quint32>(m_valueBytes.size()) });
+    return m_file.write(m_valueBytes) == m_valueBytes.size();
+}
+
+/**
+ * @brief Writes the key table and the final header.
+ */
+bool MTSettingsSnapshot::Writer::finish() {
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+        return compareBytes(a.key, b.key) < 0;
+    });
+
+    QByteArray keyBlob;
+    QByteArray table;
+    table.reserve(m_entries.size() * EntrySize);
+    quint32 count = 0;
+    for (qsizetype i = 0; i < m_entries.size(); ++i) {
+        // Equal keys are adjacent and in insertion order; keep the last one
+        if (i + 1 < m_entries.size() && m_entries[i + 1].key == m_entries[i].key) {
+            continue;
+        }
+        const Entry& e = m_entries[i];
+        appendLittleEndian<quint32>(table, static_cast<quint32>(keyBlob.size()));
+        appendLittleEndian<quint32>(table, static_cast<quint32>(e.key.size()));
+        appendLittleEndian<quint64>(table, e.valueOffset);
+        appendLittleEndian<quint32>(table, e.valueLength);
+        appendLittleEndian<quint32>(table, 0);
+        keyBlob += e.key;
+        ++count;
+    }
+    m_entries.clear();
+
+    const qint64 keysOffset = m_file.pos();
+    if (m_file.write(keyBlob) != keyBlob.size()) {
+        return false;
+    }
+    const qint64 tableOffset = m_file.pos();
+    if (m_file.write(table) != table.size()) {
+        return false;
+    }
+
+    QByteArray header(HeaderSize, '\0');
+    std::memcpy(header.data(), Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(FormatVersion, header.data() + 4);
+    qToLittleEndian<quint32>(count, header.data() + 8);
+    qToLittleEndian<quint64>(static_cast<quint64>(tableOffset), header.data() + 16);
+    qToLittleEndian<quint64>(static_cast<quint64>(keysOffset), header.data() + 24);
+
+    return m_file.seek(0) && m_file.write(header) == HeaderSize && m_file.seek(m_file.size());
+}
+
+const uchar* MTSettingsSnapshot::entry(qsizetype index) const {
+    if (!m_data || index < 0 || index >= m_count) {
+        return nullptr;
+    }
+    return m_data + m_tableOffset + index * EntrySize;
+}
+
+QByteArrayView MTSettingsSnapshot::keyBytes(qsizetype index) const {
+    const uchar* e = entry(index);
+    if (!e) {
+        return QByteArrayView();
+    }
+
+    const qint64 offset = m_keysOffset + qFromLittleEndian<quint32>(e);
+    const qint64 length = qFromLittleEndian<quint32>(e + 4);
+    if (offset + length > m_tableOffset) {
+        return QByteArrayView();
+    }
+    return QByteArrayView(reinterpret_cast<const char*>(m_data + offset), length);
+}
+
+qsizetype MTSettingsSnapshot::indexOf(QByteArrayView key) const {
+    qsizetype low = 0;
+    qsizetype high = m_count;
+    while (low < high) {
+        const qsizetype middle = low + (high - low) / 2;
+        const int result = compareBytes(keyBytes(middle), key);
+        if (result < 0) {
+            low = middle + 1;
+        } else if (result > 0) {
+            high = middle;
+        } else {
+            return middle;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,144 @@
+#ifndef MTSETTINGSSNAPSHOT_H
+#define MTSETTINGSSNAPSHOT_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+/**
+ * @class MTSettingsSnapshot
+ * @brief Read-only view of a binary settings snapshot written by MTSettings::exportSettings(BinarySnapshotFormat, ...).
+ *
+ * The file holds a value blob, a key blob and a table of entries sorted by the UTF-8 bytes of the key.
+ * It is memory-mapped on open() and only the header is validated, so opening does not depend on the number of keys.
+ * Lookups binary-search the table and values are decoded from the mapping on first access.
+ * The decoded value cache is not synchronized, so an instance must not be shared between threads.
+ */
+class MTSettingsSnapshot {
+public:
+    /**
+     * @brief Constructs a closed snapshot.
+     */
+    MTSettingsSnapshot();
+
+    /**
+     * @brief Unmaps and closes the snapshot file.
+     */
+    ~MTSettingsSnapshot();
+
+    MTSettingsSnapshot(const MTSettingsSnapshot&) = delete;
+    MTSettingsSnapshot& operator=(const MTSettingsSnapshot&) = delete;
+
+    /**
+     * @brief Memory-maps a snapshot file.
+     * @param fileName The name of the snapshot file.
+     * @return True if the file is a valid snapshot and was mapped, false otherwise.
+     */
+    bool open(const QString& fileName);
+
+    /**
+     * @brief Unmaps the file and drops all decoded values.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if a snapshot is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Returns the number of keys in the snapshot.
+     */
+    qsizetype size() const;
+
+    /**
+     * @brief Returns true if the snapshot contains the key.
+     */
+    bool contains(const QString& key) const;
+
+    /**
+     * @brief Returns the value stored for the key, decoding it on first access.
+     * @param key The settings key.
+     * @param defaultValue The value returned when the key is not present.
+     */
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+
+    /**
+     * @brief Returns the key stored at the given position of the sorted table.
+     */
+    QString keyAt(qsizetype index) const;
+
+    /**
+     * @brief Returns the value stored at the given position of the sorted table, decoding it on first access.
+     * @param index The position in the table.
+     * @param ok If not null, set to false when the entry is out of range or its value cannot be decoded.
+     *           A stored invalid QVariant is decoded successfully.
+     */
+    QVariant valueAt(qsizetype index, bool* ok = nullptr) const;
+
+    /**
+     * @brief Returns all keys in table order.
+     */
+    QStringList keys() const;
+
+    /**
+     * @class Writer
+     * @brief Incremental snapshot writer.
+     *
+     * Values are streamed to the file in the order they are added; only the keys and value offsets are kept
+     * in memory and the key table is sorted when the snapshot is finished. If a key is added twice,
+     * the last value wins.
+     */
+    class Writer {
+    public:
+        /**
+         * @brief Constructs a writer for an open, seekable file.
+         */
+        explicit Writer(QFile& file);
+
+        /**
+         * @brief Writes the header placeholder. Must be called before add().
+         */
+        bool begin();
+
+        /**
+         * @brief Appends a value to the snapshot.
+         */
+        bool add(const QString& key, const QVariant& value);
+
+        /**
+         * @brief Writes the key table and the final header.
+         */
+        bool finish();
+
+    private:
+        struct Entry {
+            QByteArray key;
+            quint64 valueOffset;
+            quint32 valueLength;
+        };
+
+        QFile& m_file;
+        QList<Entry> m_entries;
+        QByteArray m_valueBytes;  ///< Scratch buffer reused for every serialized value
+    };
+
+private:
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+    qsizetype m_count = 0;
+    qint64 m_tableOffset = 0;
+    qint64 m_keysOffset = 0;
+    mutable QHash<qsizetype, QVariant> m_decoded;  ///< Values decoded so far, by table index
+
+    const uchar* entry(qsizetype index) const;
+    QByteArrayView keyBytes(qsizetype index) const;
+    qsizetype indexOf(QByteArrayView key) const;
+};
+
+#endif // MTSETTINGSSNAPSHOT_H
@@ -0,0 +1,78 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Kolejka bez blokad dla jednego producenta i jednego konsumenta.
+// Producent (np. wątek akwizycji) wywołuje tylko push(), konsument (wątek GUI) tylko consumeAll(). Żadna ze stron
+// nie czeka na drugą: przy pełnej kolejce push() od razu zwraca false. Pojemność jest zaokrąglana w górę do potęgi
+// dwójki, a indeksy producenta i konsumenta leżą w osobnych liniach pamięci podręcznej.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : m_mask(roundUpToPowerOfTwo(capacity) - 1)
+        , m_items(m_mask + 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // Tylko wątek producenta
+    bool push(const T &item) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            // Kopia indeksu konsumenta jest odświeżana dopiero, gdy kolejka wygląda na pełną
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Tylko wątek konsumenta; przekazuje wszystkie dostępne elementy i zwraca ich liczbę
+    template <typename Consumer>
+    std::size_t consumeAll(Consumer consume) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        for (std::size_t i = head; i != tail; ++i) {
+            consume(m_items[i & m_mask]);
+        }
+        m_head.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    std::size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    // Przybliżona liczba elementów - obie strony mogą ją w tym czasie zmieniać
+    std::size_t sizeApprox() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t CacheLineSize = 64;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_head{0};  // Zapisywany przez konsumenta
+    alignas(CacheLineSize) std::atomic<std::size_t> m_tail{0};  // Zapisywany przez producenta
+    std::size_t m_cachedHead = 0;                               // Używany tylko przez producenta
+    alignas(CacheLineSize) const std::size_t m_mask;
+    std::vector<T> m_items;
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+};
+
+#endif // SPSCQUEUE_H
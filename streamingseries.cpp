@@ -0,0 +1 @@
+#include "streamingseries.h"
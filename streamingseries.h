@@ -0,0 +1,140 @@
+#ifndef STREAMINGSERIES_H
+#define STREAMINGSERIES_H
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+#include <QPointF>
+#include <QTimer>
+#include <QDateTime>
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QDateTimeAxis>
+
+// Seria dla danych na żywo o stałym zużyciu pamięci.
+// Próbki (czas w ms od epoki, wartość) trafiają do bufora pierścieniowego o stałej pojemności - najstarsze są
+// nadpisywane. Dopisywanie nie dotyka wykresu; zmiany są przenoszone do QLineSeries najwyżej raz na klatkę,
+// jednym wywołaniem replace(). Przy włączonym autoprzewijaniu oś czasu pokazuje okno kończące się na najnowszej
+// próbce.
+class StreamingSeries : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StreamingSeries(QLineSeries *series, QDateTimeAxis *axisX, int capacity, QObject *parent = nullptr)
+        : QObject(parent)
+        , m_series(series)
+        , m_axisX(axisX)
+        , m_buffer(qMax(1, capacity))
+    {
+        m_frame.reserve(m_buffer.size());
+
+        m_frameTimer.setInterval(16);  // ok. 60 klatek na sekundę
+        m_frameTimer.setTimerType(Qt::PreciseTimer);
+        connect(&m_frameTimer, &QTimer::timeout, this, &StreamingSeries::commit);
+    }
+
+    void append(qint64 msecs, qreal value) {
+        m_buffer[(m_head + m_count) % m_buffer.size()] = QPointF(msecs, value);
+        if (m_count < m_buffer.size()) {
+            ++m_count;
+        } else {
+            m_head = (m_head + 1) % m_buffer.size();  // Bufor pełny - nadpisana najstarsza próbka
+        }
+        scheduleCommit();
+    }
+
+    void append(const QList<QPointF> &samples) {
+        for (const QPointF &sample : samples) {
+            append(qint64(sample.x()), sample.y());
+        }
+    }
+
+    void clear() {
+        m_head = 0;
+        m_count = 0;
+        scheduleCommit();
+    }
+
+    qsizetype size() const {
+        return m_count;
+    }
+
+    qsizetype capacity() const {
+        return m_buffer.size();
+    }
+
+    QLineSeries *series() const {
+        return m_series;
+    }
+
+    // Szerokość okna osi czasu przy autoprzewijaniu; 0 - okno obejmuje cały bufor
+    void setWindow(qint64 msecs) {
+        m_windowMsecs = qMax<qint64>(0, msecs);
+    }
+
+    qint64 window() const {
+        return m_windowMsecs;
+    }
+
+    void setAutoScroll(bool enabled) {
+        m_autoScroll = enabled;
+        if (enabled) {
+            scheduleCommit();
+        }
+    }
+
+    bool autoScroll() const {
+        return m_autoScroll;
+    }
+
+    // Odstęp między aktualizacjami widoku w ms
+    void setFrameInterval(int msecs) {
+        m_frameTimer.setInterval(qMax(1, msecs));
+    }
+
+public slots:
+    // Przenosi zawartość bufora do serii; wywoływane przez zegar klatek, można też wywołać ręcznie
+    void commit() {
+        m_frameTimer.stop();  // Zegar chodzi tylko wtedy, gdy są nowe próbki
+        if (!m_dirty || !m_series) {
+            return;
+        }
+        m_dirty = false;
+
+        // Seria współdzieli bufor klatki; przy następnej klatce clear() przydziela nowy blok tej samej
+        // pojemności, a poprzedni zwalnia seria - pamięć nie rośnie
+        m_frame.clear();
+        for (qsizetype i = 0; i < m_count; ++i) {
+            m_frame.append(m_buffer[(m_head + i) % m_buffer.size()]);
+        }
+        m_series->replace(m_frame);
+
+        if (m_autoScroll && m_axisX && m_count > 0) {
+            const qint64 newest = qint64(m_frame.constLast().x());
+            const qint64 oldest = m_windowMsecs > 0 ? newest - m_windowMsecs : qint64(m_frame.constFirst().x());
+            if (newest > oldest) {
+                m_axisX->setRange(QDateTime::fromMSecsSinceEpoch(oldest), QDateTime::fromMSecsSinceEpoch(newest));
+            }
+        }
+    }
+
+private:
+    QPointer<QLineSeries> m_series;
+    QPointer<QDateTimeAxis> m_axisX;
+    QList<QPointF> m_buffer;  // Bufor pierścieniowy o stałym rozmiarze
+    qsizetype m_head = 0;     // Indeks najstarszej próbki
+    qsizetype m_count = 0;
+    QList<QPointF> m_frame;   // Próbki w kolejności czasu, przekazywane do serii
+    QTimer m_frameTimer;
+    qint64 m_windowMsecs = 0;
+    bool m_autoScroll = true;
+    bool m_dirty = false;
+
+    void scheduleCommit() {
+        m_dirty = true;
+        if (!m_frameTimer.isActive()) {
+            m_frameTimer.start();
+        }
+    }
+};
+
+#endif // STREAMINGSERIES_H
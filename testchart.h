@@ -12,12 +12,24 @@
 #include <QLineSeries>
 #include <QRandomGenerator>
 #include <QGraphicsScene>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsRectItem>
+#include <QGraphicsView>
+#include <QPainter>
+#include <QPixmap>
 #include "chartcomment.h"
+#include "decimatedseries.h"
+#include "streamingseries.h"
+#include "spscqueue.h"
+
+#include <memory>
 
 class TestChart : public QChart {
     Q_OBJECT
 
 public:
+    using SampleQueue = SpscQueue<QPointF>;  // Próbki (czas w ms od epoki, wartość)
+
     explicit TestChart(QGraphicsItem *parent = nullptr, Qt::WindowFlags wFlags = {})
         : QChart(parent, wFlags)
         , axisX(new QDateTimeAxis(this))
@@ -36,9 +48,60 @@ public:
         axisX->setRange(QDateTime::currentDateTime().addDays(-2), QDateTime::currentDateTime().addDays(+2));
         axisY->setRange(-10, 10);
 
+        // Licznik zmian zakresu osi - pozwala zmierzyć, ile razy przesunięcie lub powiększenie przeliczyło widok
+        connect(axisX, &QDateTimeAxis::rangeChanged, this, [this]() { ++rangeChanges; });
+        connect(axisY, &QValueAxis::rangeChanged, this, [this]() { ++rangeChanges; });
+
+        viewTimer.setSingleShot(true);
+        viewTimer.setInterval(16);  // ok. 60 klatek na sekundę
+        viewTimer.setTimerType(Qt::PreciseTimer);
+        connect(&viewTimer, &QTimer::timeout, this, &TestChart::applyPendingViewTransform);
+
+        // Po chwili bez ruchu myszy podczas przeciągania widok jest rysowany w pełnej jakości
+        idleTimer.setSingleShot(true);
+        idleTimer.setInterval(150);
+        connect(&idleTimer, &QTimer::timeout, this, &TestChart::endCachedInteraction);
+        // Zrzut i zasłona mają rozmiar starego obszaru wykresu - po jego zmianie nie pasują do widoku
+        connect(this, &QChart::plotAreaChanged, this, &TestChart::endCachedInteraction);
+
         addRandomLineSerie();
     }
 
+    // Przesunięcia i powiększenia z myszy są zbierane i nakładane raz na klatkę jedną zmianą zakresu obu osi.
+    // Wyłączenie przywraca natychmiastowe ustawianie każdej osi osobno przy każdym zdarzeniu.
+    void setCoalescedViewUpdates(bool enabled) {
+        if (!enabled) {
+            applyPendingViewTransform();
+        }
+        coalescedViewUpdates = enabled;
+    }
+
+    bool isCoalescedViewUpdates() const {
+        return coalescedViewUpdates;
+    }
+
+    // Podczas przeciągania przesuwany jest tylko zrzut obszaru wykresu (i komentarze), a osie i serie są
+    // przeliczane raz - po puszczeniu przycisku albo po chwili bez ruchu
+    void setCachedInteraction(bool enabled) {
+        if (!enabled) {
+            endCachedInteraction();
+        }
+        cachedInteraction = enabled;
+    }
+
+    bool isCachedInteraction() const {
+        return cachedInteraction;
+    }
+
+    // Liczba zmian zakresu osi od utworzenia wykresu lub ostatniego resetRangeChangeCount()
+    int rangeChangeCount() const {
+        return rangeChanges;
+    }
+
+    void resetRangeChangeCount() {
+        rangeChanges = 0;
+    }
+
     void addRandomLineSerie() {
         qint64 xMin = axisX->min().toMSecsSinceEpoch();
         qint64 xMax = axisX->max().toMSecsSinceEpoch();
@@ -48,21 +111,98 @@ public:
 
         QLineSeries *xSeries = new QLineSeries();
 
+        QList<QPointF> points;
         for (qint64 x = xMin; x <= xMax; x += xStep) {
-            xSeries->append(x, getRandomQReal(-10, 10));
+            points.append(QPointF(x, getRandomQReal(-10, 10)));
         }
+        xSeries->replace(points);  // Jedno przerysowanie zamiast jednego na punkt
 
         this->addSeries(xSeries);
         xSeries->attachAxis(axisX);
         xSeries->attachAxis(axisY);
     }
 
+    // Seria z milionami punktów (błądzenie losowe w widocznym zakresie osi X), wyświetlana przez DecimatedSeries
+    DecimatedSeries *addRandomDecimatedSerie(qsizetype pointCount) {
+        qint64 xMin = axisX->min().toMSecsSinceEpoch();
+        qint64 xMax = axisX->max().toMSecsSinceEpoch();
+        qreal xStep = qreal(xMax - xMin) / qMax<qsizetype>(1, pointCount - 1);
+
+        QList<qreal> xs(pointCount);
+        QList<qreal> ys(pointCount);
+        qreal y = 0;
+        for (qsizetype i = 0; i < pointCount; ++i) {
+            y = qBound<qreal>(-10, y + getRandomQReal(-0.5, 0.5), 10);
+            xs[i] = xMin + i * xStep;
+            ys[i] = y;
+        }
+
+        QLineSeries *xSeries = new QLineSeries();
+        this->addSeries(xSeries);
+        xSeries->attachAxis(axisX);
+        xSeries->attachAxis(axisY);
+
+        DecimatedSeries *decimated = new DecimatedSeries(xSeries, axisX, this);
+        decimated->setData(std::move(xs), std::move(ys));
+        return decimated;
+    }
+
+    // Seria dla danych na żywo: bufor pierścieniowy o pojemności capacity próbek, oś czasu przewijana
+    // tak, by pokazywała ostatnie windowMsecs
+    StreamingSeries *addStreamingSerie(int capacity, qint64 windowMsecs) {
+        QLineSeries *xSeries = new QLineSeries();
+        this->addSeries(xSeries);
+        xSeries->attachAxis(axisX);
+        xSeries->attachAxis(axisY);
+
+        StreamingSeries *streaming = new StreamingSeries(xSeries, axisX, capacity, this);
+        streaming->setWindow(windowMsecs);
+        return streaming;
+    }
+
+    // Kolejka, do której wątek akwizycji może dopisywać próbki serii bez blokowania (jeden producent na kolejkę).
+    // Wykres opróżnia wszystkie kolejki raz na klatkę i przekazuje próbki każdej serii jedną paczką.
+    // Gdy kolejka jest pełna, push() zwraca false i próbka jest tracona - producent nigdy nie czeka na GUI.
+    std::shared_ptr<SampleQueue> addSampleQueue(StreamingSeries *series, std::size_t capacity = 65536) {
+        auto queue = std::make_shared<SampleQueue>(capacity);
+        sampleFeeds.append({ series, queue });
+
+        if (!ingestTimer) {
+            ingestTimer = new QTimer(this);
+            ingestTimer->setInterval(16);  // ok. 60 klatek na sekundę
+            ingestTimer->setTimerType(Qt::PreciseTimer);
+            connect(ingestTimer, &QTimer::timeout, this, &TestChart::drainSampleQueues);
+        }
+        ingestTimer->start();
+        return queue;
+    }
+
+    void removeSampleQueue(const std::shared_ptr<SampleQueue> &queue) {
+        sampleFeeds.removeIf([&queue](const SampleFeed &feed) {
+            return feed.queue == queue;
+        });
+        if (sampleFeeds.isEmpty() && ingestTimer) {
+            ingestTimer->stop();
+        }
+    }
+
 protected:
     // Obsługa przewijania myszą (zoom)
     void wheelEvent(QGraphicsSceneWheelEvent *event) override {
+        endCachedInteraction();  // Powiększenie zmienia skalę - zrzut przestaje pasować
+
         double scalePercentage = (event->delta() > 0) ? -5.0 : 5.0;
 
-        if (event->modifiers() & Qt::ControlModifier) {
+        if (coalescedViewUpdates) {
+            // Zakres rośnie o scalePercentage z każdej strony
+            double factor = 1.0 + 2.0 * scalePercentage / 100.0;
+            if (event->modifiers() & Qt::ControlModifier) {
+                pendingScaleX *= factor;
+            } else {
+                pendingScaleY *= factor;
+            }
+            scheduleViewUpdate();
+        } else if (event->modifiers() & Qt::ControlModifier) {
             adjustDateTimeAxisRange(scalePercentage);
         } else {
             adjustValueAxisRange(scalePercentage);
@@ -98,6 +238,13 @@ protected:
     // Obsługa przesuwania wykresu myszą
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override {
         lastMousePosition = event->pos();  // Zapisanie pozycji kliknięcia
+        dragging = event->button() == Qt::LeftButton;
+        event->accept();
+    }
+
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override {
+        dragging = false;
+        endCachedInteraction();
         event->accept();
     }
 
@@ -105,6 +252,30 @@ protected:
         QPointF delta = event->pos() - lastMousePosition;  // Obliczenie przesunięcia
         lastMousePosition = event->pos();
 
+        if (dragging && cachedInteraction && !cacheLayer) {
+            beginCachedInteraction();
+        }
+        if (cacheLayer) {
+            // Tylko przesunięcie zrzutu i komentarzy - bez zmiany zakresu osi
+            cachedPan += delta;
+            cacheImage->setPos(plotArea().topLeft() + cachedPan);
+            for (const QPointer<ChartComment> &comment : std::as_const(movedComments)) {
+                if (comment) {
+                    comment->moveBy(delta.x(), delta.y());
+                }
+            }
+            idleTimer.start();
+            event->accept();
+            return;
+        }
+
+        if (coalescedViewUpdates) {
+            pendingPan += delta;
+            scheduleViewUpdate();
+            event->accept();
+            return;
+        }
+
         // Przesunięcie zakresu osi X
         qint64 xMin = axisX->min().toMSecsSinceEpoch();
         qint64 xMax = axisX->max().toMSecsSinceEpoch();
@@ -150,9 +321,166 @@ protected:
 
 
 private:
+    struct SampleFeed {
+        QPointer<StreamingSeries> series;
+        std::shared_ptr<SampleQueue> queue;
+    };
+
     QDateTimeAxis *axisX;
     QValueAxis *axisY;
     QPointF lastMousePosition;  // Przechowuje ostatnią pozycję myszy podczas przesuwania
+    QList<SampleFeed> sampleFeeds;
+    QTimer *ingestTimer = nullptr;
+    QList<QPointF> sampleBatch;  // Bufor wielokrotnego użytku dla próbek jednej serii
+
+    // Zebrane, jeszcze nienałożone przesunięcie (w pikselach) i powiększenie
+    bool coalescedViewUpdates = true;
+    QTimer viewTimer;
+    QPointF pendingPan;
+    double pendingScaleX = 1.0;
+    double pendingScaleY = 1.0;
+    int rangeChanges = 0;
+
+    // Stan przeciągania z użyciem zrzutu obszaru wykresu
+    bool cachedInteraction = true;
+    bool dragging = false;
+    QGraphicsRectItem *cacheLayer = nullptr;  // Przycina i zasłania obszar wykresu na czas przeciągania
+    QGraphicsPixmapItem *cacheImage = nullptr;
+    QPointF cachedPan;                        // Przesunięcie zrzutu od początku przeciągania
+    QList<QPair<QPointer<QAbstractSeries>, qreal>> hiddenSeries;  // Serie ukryte pod zasłoną i ich krycie
+    QList<QPointer<ChartComment>> movedComments;
+    QTimer idleTimer;
+
+    void beginCachedInteraction() {
+        applyPendingViewTransform();  // Zrzut ma pokazywać aktualny zakres osi
+
+        QRectF area = plotArea();
+        if (cacheLayer || !scene() || area.isEmpty()) {
+            return;
+        }
+        qreal ratio = scene()->views().isEmpty() ? 1.0 : scene()->views().first()->devicePixelRatioF();
+
+        // Zrzut bez komentarzy - są przesuwane osobno jako elementy sceny
+        movedComments.clear();
+        for (ChartComment *comment : getChartComments(this)) {
+            movedComments.append(comment);
+            comment->setVisible(false);
+        }
+        QPixmap pixmap((area.size() * ratio).toSize());
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        scene()->render(&painter, QRectF(QPointF(), area.size()), mapRectToScene(area));
+        painter.end();
+        for (const QPointer<ChartComment> &comment : std::as_const(movedComments)) {
+            comment->setVisible(true);
+        }
+
+        cacheLayer = new QGraphicsRectItem(area, this);
+        cacheLayer->setPen(Qt::NoPen);
+        cacheLayer->setBrush(isPlotAreaBackgroundVisible() ? plotAreaBackgroundBrush() : backgroundBrush());
+        cacheLayer->setFlag(QGraphicsItem::ItemClipsChildrenToShape);
+        cacheLayer->setZValue(40);  // Nad elementami wykresu, pod komentarzami (50, 51)
+        cacheImage = new QGraphicsPixmapItem(pixmap, cacheLayer);
+        cacheImage->setPos(area.topLeft());
+        cachedPan = QPointF();
+
+        // Przezroczyste serie nie są rysowane pod zasłoną; w przeciwieństwie do setVisible() krycie nie zmienia
+        // legendy ani rozmieszczenia wykresu
+        hiddenSeries.clear();
+        for (QAbstractSeries *chartSeries : series()) {
+            if (chartSeries->isVisible() && chartSeries->opacity() > 0) {
+                hiddenSeries.append(qMakePair(QPointer<QAbstractSeries>(chartSeries), chartSeries->opacity()));
+                chartSeries->setOpacity(0);
+            }
+        }
+    }
+
+    // Usuwa zrzut i nakłada całe przesunięcie jedną zmianą zakresu osi - jedno pełne przerysowanie
+    void endCachedInteraction() {
+        idleTimer.stop();
+        if (!cacheLayer) {
+            return;
+        }
+
+        for (const QPointer<ChartComment> &comment : std::as_const(movedComments)) {
+            if (comment) {
+                comment->moveBy(-cachedPan.x(), -cachedPan.y());
+            }
+        }
+        movedComments.clear();
+        for (const auto &[chartSeries, opacity] : std::as_const(hiddenSeries)) {
+            if (chartSeries) {
+                chartSeries->setOpacity(opacity);
+            }
+        }
+        hiddenSeries.clear();
+
+        delete cacheLayer;  // Usuwa też cacheImage
+        cacheLayer = nullptr;
+        cacheImage = nullptr;
+
+        pendingPan += cachedPan;
+        cachedPan = QPointF();
+        applyPendingViewTransform();
+    }
+
+    void scheduleViewUpdate() {
+        if (!viewTimer.isActive()) {
+            viewTimer.start();
+        }
+    }
+
+    // Nakłada zebrane zmiany widoku jednym wywołaniem zoomIn(), które ustawia zakres obu osi naraz
+    void applyPendingViewTransform() {
+        viewTimer.stop();
+        if (pendingPan.isNull() && pendingScaleX == 1.0 && pendingScaleY == 1.0) {
+            return;
+        }
+
+        QRectF area = plotArea();
+        QRectF view(0, 0, area.width() * pendingScaleX, area.height() * pendingScaleY);
+        view.moveCenter(area.center() - pendingPan);
+
+        pendingPan = QPointF();
+        pendingScaleX = 1.0;
+        pendingScaleY = 1.0;
+
+        if (!series().isEmpty()) {
+            zoomIn(view);
+            return;
+        }
+
+        // Bez serii zoomIn() nie zmienia osi - zakres jest wyliczany bezpośrednio
+        double xMin = axisX->min().toMSecsSinceEpoch();
+        double xRange = axisX->max().toMSecsSinceEpoch() - xMin;
+        double yMax = axisY->max();
+        double yRange = yMax - axisY->min();
+        axisX->setRange(
+            QDateTime::fromMSecsSinceEpoch(qint64(xMin + (view.left() - area.left()) / area.width() * xRange)),
+            QDateTime::fromMSecsSinceEpoch(qint64(xMin + (view.right() - area.left()) / area.width() * xRange))
+            );
+        axisY->setRange(yMax - (view.bottom() - area.top()) / area.height() * yRange,
+                        yMax - (view.top() - area.top()) / area.height() * yRange);
+    }
+
+    // Wywoływane przez zegar klatek: każda seria dostaje wszystkie nowe próbki naraz i jedno przerysowanie
+    void drainSampleQueues() {
+        sampleFeeds.removeIf([](const SampleFeed &feed) {
+            return !feed.series;
+        });
+        for (const SampleFeed &feed : std::as_const(sampleFeeds)) {
+            sampleBatch.clear();
+            feed.queue->consumeAll([this](const QPointF &sample) {
+                sampleBatch.append(sample);
+            });
+            if (!sampleBatch.isEmpty()) {
+                feed.series->append(sampleBatch);
+                feed.series->commit();
+            }
+        }
+    }
 
     void adjustDateTimeAxisRange(double percentage) {
         QDateTime minTime = axisX->min();
@@ -38,7 +38,7 @@ void TestWindow::on_actionLoad_QSS_triggered()
         fileName += ".qss";
     }
 
-    mtQss->importQss(fileName);
+    mtQss->importQssAsync(fileName);
 }
 
 
@@ -66,6 +66,7 @@ void TestWindow::testChartComment() {
     TestChart *chart = new TestChart();
 
     chart->setTitle("Test wykresu z komentarzem");
+    chart->addRandomDecimatedSerie(1000000);
 
     // Tworzenie widoku wykresu
     QChartView *chartView = new QChartView(chart);